@@ -3,6 +3,7 @@
 
 #include "../../common/headers/common.h"
 #include "../../common/headers/endpoint.h"
+#include "../../common/headers/sockopt.h"
 
 /*
  * Used as client for connection to local address
@@ -25,6 +25,9 @@ struct client* create_client(const char* ip, const int port) {
   client->sfd = socket(AF_INET, SOCK_STREAM, 0);
   if (client->sfd == -1)
     print_error("socket");
+  
+  /* Send first request in SYN */
+  set_fastopen_connect(client->sfd);
 
   return client;
 }
@@ -80,26 +83,27 @@ void process_input(struct client* client) {
 
 /*
  * send_message - used to send message to server. Sends
- * buffer length first, converted to Big Endian, then sends
- * message itself.
+ * buffer length, converted to Big Endian, and message itself
+ * in one call, so whole frame fits in SYN with Fast Open.
  * @client - pointer to an object of client struct
  * @buffer - string that needs to be sent
  */
 void send_message(struct client* client, const char* buffer) {
   uint32_t buffer_len = strlen(buffer);
   uint32_t net_len = htonl(buffer_len);
+  struct iovec iov[2] = {
+    { .iov_base = &net_len, .iov_len = sizeof(net_len) },
+    { .iov_base = (void*) buffer, .iov_len = buffer_len },
+  };
+  struct msghdr msg = { .msg_iov = iov, .msg_iovlen = 2 };
   
-  /* Send message length */
-  if (send(client->sfd, &net_len, sizeof(net_len), 0) == -1)
-    print_error("send");
+  /* Send message length and message */
+  if (sendmsg(client->sfd, &msg, 0) == -1)
+    print_error("sendmsg");
   
   /* Log message len */
   printf("CLIENT: Send message len: %d\n", buffer_len);
   
-  /* Send message */
-  if (send(client->sfd, buffer, buffer_len, 0) == -1)
-    print_error("send");
-  
   /* Log message*/
   printf("CLIENT: Send message: %s\n", buffer);
 }
@@ -16,6 +16,19 @@
 #define BUFFER_SIZE 128
 #define SERVER_IP "127.0.0.1" 
 #define SERVER_PORT 8080
+#ifndef FASTOPEN
+#define FASTOPEN 0
+#endif
+#define FASTOPEN_QUEUE 16
+#ifndef RESPONSE_CACHE
+#define RESPONSE_CACHE 0
+#endif
+#ifndef CACHE_BUDGET
+#define CACHE_BUDGET (16 * 1024 * 1024)
+#endif
+#define CACHE_SHARDS 16
+#define CACHE_SHARD_SLOTS 4096
+#define CACHE_STATS_PERIOD 10000
 #define print_error(msg) do {perror(msg); \
   exit(EXIT_FAILURE);} while(0)
 
@@ -0,0 +1,11 @@
+#ifndef SOCKOPT_H
+#define SOCKOPT_H
+
+#include "common.h"
+#include <netinet/tcp.h>
+
+void set_fastopen(int fd);
+
+void set_fastopen_connect(int fd);
+
+#endif // !SOCKOPT_H
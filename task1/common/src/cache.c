@@ -0,0 +1,348 @@
+#include "../headers/cache.h"
+#include <inttypes.h>
+
+/*
+ * create_cache - used to create an object of
+ * response_cache struct.
+ * @budget - memory for requests and responses in bytes
+ *
+ * Return: pointer to an object of response_cache struct
+ */
+struct response_cache* create_cache(size_t budget) {
+  struct response_cache* cache = (struct response_cache*) calloc(1, sizeof(struct response_cache));
+  if (!cache)
+    print_error("calloc");
+
+  for (int i = 0; i < CACHE_SHARDS; i++) {
+    struct cache_shard* shard = &cache->shards[i];
+
+    shard->buckets = (struct cache_entry**) calloc(CACHE_SHARD_SLOTS, sizeof(struct cache_entry*));
+    shard->slots = (struct cache_entry**) calloc(CACHE_SHARD_SLOTS, sizeof(struct cache_entry*));
+    if (!shard->buckets || !shard->slots)
+      print_error("calloc");
+    
+    if (pthread_mutex_init(&shard->mutex, NULL) != 0)
+      print_error("pthread_mutex_init");
+  }
+
+  cache->shard_budget = budget / CACHE_SHARDS;
+  atomic_init(&cache->lookups, 0);
+
+  return cache;
+}
+
+/*
+ * hash_request - used to get FNV-1a hash of request.
+ * @key - request
+ * @key_len - length of request
+ *
+ * Return: hash
+ */
+uint64_t hash_request(const char* key, size_t key_len) {
+  uint64_t hash = 14695981039346656037ULL;
+
+  for (size_t i = 0; i < key_len; i++) {
+    hash ^= (unsigned char) key[i];
+    hash *= 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+/*
+ * find_entry - used to find entry with the same request in
+ * bucket of shard. Must be called with mutex of shard locked.
+ * @shard - pointer to an object of cache_shard struct
+ * @hash - hash of request
+ * @key - request
+ * @key_len - length of request
+ *
+ * Return: pointer to an object of cache_entry struct, NULL
+ * if request is not cached
+ */
+struct cache_entry* find_entry(struct cache_shard* shard, uint64_t hash, 
+                               const char* key, size_t key_len) {
+  struct cache_entry* entry = shard->buckets[(hash / CACHE_SHARDS) % CACHE_SHARD_SLOTS];
+  
+  while (entry && (entry->hash != hash || entry->key_len != key_len || 
+                   memcmp(entry->key, key, key_len) != 0))
+    entry = entry->next;
+
+  return entry;
+}
+
+/*
+ * cache_lookup - used to find response for request.
+ * Logs statistics every CACHE_STATS_PERIOD lookups.
+ * @cache - pointer to an object of response_cache struct
+ * @key - request
+ * @key_len - length of request
+ *
+ * Return: copy of response that should be freed manually,
+ * NULL if response is not cached
+ */
+char* cache_lookup(struct response_cache* cache, const char* key, size_t key_len) {
+  uint64_t hash = hash_request(key, key_len);
+  struct cache_shard* shard = &cache->shards[hash % CACHE_SHARDS];
+  struct cache_entry* entry;
+  char* value = NULL;
+
+  pthread_mutex_lock(&shard->mutex);
+  
+  /* Find entry with the same request */
+  entry = find_entry(shard, hash, key, key_len);
+  if (entry) {
+    entry->referenced = 1;
+    shard->hits++;
+    
+    /* Copy response, entry may be evicted after unlock */
+    value = (char*) malloc(entry->value_len + 1);
+    if (!value)
+      print_error("malloc");
+    memcpy(value, entry->value, entry->value_len);
+    value[entry->value_len] = '\0';
+  }
+  else {
+    shard->misses++;
+  }
+
+  pthread_mutex_unlock(&shard->mutex);
+  
+  if ((atomic_fetch_add_explicit(&cache->lookups, 1, memory_order_relaxed) + 1) % CACHE_STATS_PERIOD == 0)
+    print_cache_stats(cache);
+
+  return value;
+}
+
+/*
+ * cache_lookup_into - used to find response for request and
+ * copy it to buffer of caller, so hit does not allocate.
+ * Logs statistics every CACHE_STATS_PERIOD lookups.
+ * @cache - pointer to an object of response_cache struct
+ * @key - request
+ * @key_len - length of request
+ * @buffer - buffer for terminated response
+ * @size - size of buffer
+ *
+ * Return: length of response, -1 if response is not cached
+ * or does not fit buffer
+ */
+ssize_t cache_lookup_into(struct response_cache* cache, const char* key, size_t key_len,
+                          char* buffer, size_t size) {
+  uint64_t hash = hash_request(key, key_len);
+  struct cache_shard* shard = &cache->shards[hash % CACHE_SHARDS];
+  struct cache_entry* entry;
+  ssize_t length = -1;
+
+  pthread_mutex_lock(&shard->mutex);
+  
+  entry = find_entry(shard, hash, key, key_len);
+  if (entry && entry->value_len < size) {
+    entry->referenced = 1;
+    shard->hits++;
+    
+    /* Copy response while entry can not be evicted */
+    memcpy(buffer, entry->value, entry->value_len);
+    buffer[entry->value_len] = '\0';
+    length = entry->value_len;
+  }
+  else {
+    shard->misses++;
+  }
+
+  pthread_mutex_unlock(&shard->mutex);
+  
+  if ((atomic_fetch_add_explicit(&cache->lookups, 1, memory_order_relaxed) + 1) % CACHE_STATS_PERIOD == 0)
+    print_cache_stats(cache);
+
+  return length;
+}
+
+/*
+ * cache_store - used to put response for request to cache.
+ * Evicts entries by CLOCK until new entry fits memory
+ * budget and has free slot. Response that does not fit
+ * budget at all is not cached.
+ * @cache - pointer to an object of response_cache struct
+ * @key - request
+ * @key_len - length of request
+ * @value - response
+ * @value_len - length of response
+ */
+void cache_store(struct response_cache* cache, const char* key, size_t key_len,
+                 const char* value, size_t value_len) {
+  uint64_t hash = hash_request(key, key_len);
+  struct cache_shard* shard = &cache->shards[hash % CACHE_SHARDS];
+  struct cache_entry** bucket;
+  struct cache_entry* entry;
+  size_t size = sizeof(struct cache_entry) + key_len + value_len;
+
+  if (size > cache->shard_budget)
+    return;
+
+  pthread_mutex_lock(&shard->mutex);
+
+  /* Other thread already stored response */
+  bucket = &shard->buckets[(hash / CACHE_SHARDS) % CACHE_SHARD_SLOTS];
+  if (find_entry(shard, hash, key, key_len)) {
+    pthread_mutex_unlock(&shard->mutex);
+    return;
+  }
+  
+  /* Make room */
+  while (shard->amount == CACHE_SHARD_SLOTS || shard->bytes + size > cache->shard_budget)
+    evict_entry(shard);
+  
+  entry = (struct cache_entry*) malloc(sizeof(struct cache_entry));
+  if (!entry)
+    print_error("malloc");
+  entry->key = (char*) malloc(key_len);
+  entry->value = (char*) malloc(value_len);
+  if (!entry->key || !entry->value)
+    print_error("malloc");
+  
+  memcpy(entry->key, key, key_len);
+  memcpy(entry->value, value, value_len);
+  entry->hash = hash;
+  entry->key_len = key_len;
+  entry->value_len = value_len;
+  entry->referenced = 0;
+  
+  /* Link entry to bucket */
+  entry->next = *bucket;
+  *bucket = entry;
+  
+  /* Put entry to free slot of clock */
+  while (shard->slots[shard->hand])
+    shard->hand = (shard->hand + 1) % CACHE_SHARD_SLOTS;
+  shard->slots[shard->hand] = entry;
+  shard->hand = (shard->hand + 1) % CACHE_SHARD_SLOTS;
+
+  shard->amount++;
+  shard->bytes += size;
+
+  pthread_mutex_unlock(&shard->mutex);
+}
+
+/*
+ * evict_entry - used to evict one entry of shard by CLOCK.
+ * Must be called with mutex of shard locked, shard should
+ * not be empty.
+ * @shard - pointer to an object of cache_shard struct
+ */
+void evict_entry(struct cache_shard* shard) {
+  struct cache_entry* entry;
+  struct cache_entry** link;
+
+  while (1) {
+    entry = shard->slots[shard->hand];
+    
+    /* Give second chance to used entry */
+    if (entry && entry->referenced)
+      entry->referenced = 0;
+    else if (entry)
+      break;
+
+    shard->hand = (shard->hand + 1) % CACHE_SHARD_SLOTS;
+  }
+  
+  /* Unlink entry from bucket */
+  link = &shard->buckets[(entry->hash / CACHE_SHARDS) % CACHE_SHARD_SLOTS];
+  while (*link != entry)
+    link = &(*link)->next;
+  *link = entry->next;
+
+  shard->slots[shard->hand] = NULL;
+  shard->amount--;
+  shard->bytes -= sizeof(struct cache_entry) + entry->key_len + entry->value_len;
+  shard->evictions++;
+
+  free(entry->key);
+  free(entry->value);
+  free(entry);
+}
+
+/*
+ * cached_reply - used to get reply for message. Cached
+ * reply skips handler, otherwise reply of handler is put
+ * to cache. Without cache handler is always called.
+ * @cache - pointer to an object of response_cache struct or NULL
+ * @message - message from client
+ * @handler - function that builds reply, result is freed manually
+ *
+ * Return: reply that should be freed manually
+ */
+char* cached_reply(struct response_cache* cache, char* message, char* (*handler)(char*)) {
+  size_t message_len = strlen(message);
+  char* reply;
+
+  if (!cache)
+    return handler(message);
+
+  reply = cache_lookup(cache, message, message_len);
+  if (reply)
+    return reply;
+
+  reply = handler(message);
+  cache_store(cache, message, message_len, reply, strlen(reply));
+
+  return reply;
+}
+
+/*
+ * get_cache_stats - used to sum statistics of shards.
+ * @cache - pointer to an object of response_cache struct
+ * @stats - pointer to store statistics
+ */
+void get_cache_stats(struct response_cache* cache, struct cache_stats* stats) {
+  memset(stats, 0, sizeof(*stats));
+
+  for (int i = 0; i < CACHE_SHARDS; i++) {
+    struct cache_shard* shard = &cache->shards[i];
+
+    pthread_mutex_lock(&shard->mutex);
+    stats->hits += shard->hits;
+    stats->misses += shard->misses;
+    stats->evictions += shard->evictions;
+    stats->amount += shard->amount;
+    stats->bytes += shard->bytes;
+    pthread_mutex_unlock(&shard->mutex);
+  }
+}
+
+/*
+ * print_cache_stats - used to log statistics of cache.
+ * @cache - pointer to an object of response_cache struct
+ */
+void print_cache_stats(struct response_cache* cache) {
+  struct cache_stats stats;
+
+  get_cache_stats(cache, &stats);
+  printf("CACHE: hits %" PRIu64 ", misses %" PRIu64 ", evictions %" PRIu64 ", entries %zu, bytes %zu\n",
+         stats.hits, stats.misses, stats.evictions, stats.amount, stats.bytes);
+}
+
+/*
+ * free_cache - used to free allocated memory
+ * for response_cache struct and its entries.
+ * @cache - pointer to an object of response_cache struct
+ */
+void free_cache(struct response_cache* cache) {
+  for (int i = 0; i < CACHE_SHARDS; i++) {
+    struct cache_shard* shard = &cache->shards[i];
+
+    for (size_t j = 0; j < CACHE_SHARD_SLOTS; j++) {
+      if (shard->slots[j]) {
+        free(shard->slots[j]->key);
+        free(shard->slots[j]->value);
+        free(shard->slots[j]);
+      }
+    }
+    
+    free(shard->buckets);
+    free(shard->slots);
+    pthread_mutex_destroy(&shard->mutex);
+  }
+
+  free(cache);
+}
@@ -0,0 +1,36 @@
+#include "../headers/sockopt.h"
+
+/*
+ * set_fastopen - used to enable TCP Fast Open on listening
+ * socket, so data of the first request can arrive in SYN.
+ * Does nothing if project is built without FASTOPEN.
+ * Must be called before listen.
+ * @fd - file descriptor of listening socket
+ */
+void set_fastopen(int fd) {
+  int qlen = FASTOPEN_QUEUE;
+
+  if (!FASTOPEN)
+    return;
+
+  if (setsockopt(fd, IPPROTO_TCP, TCP_FASTOPEN, &qlen, sizeof(qlen)) == -1)
+    print_error("setsockopt");
+}
+
+/*
+ * set_fastopen_connect - used to enable TCP Fast Open on
+ * client socket. Connect is deferred until the first send,
+ * which carries the request in SYN when server cookie is
+ * known. Does nothing if project is built without FASTOPEN.
+ * Must be called before connect.
+ * @fd - file descriptor of client socket
+ */
+void set_fastopen_connect(int fd) {
+  int enable = 1;
+
+  if (!FASTOPEN)
+    return;
+
+  if (setsockopt(fd, IPPROTO_TCP, TCP_FASTOPEN_CONNECT, &enable, sizeof(enable)) == -1)
+    print_error("setsockopt");
+}
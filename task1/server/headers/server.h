@@ -3,6 +3,8 @@
 
 #include "../../common/headers/common.h"
 #include "../../common/headers/endpoint.h"
+#include "../../common/headers/sockopt.h"
+#include "../../common/headers/cache.h"
 #include "client.h"
 
 /**
@@ -17,6 +19,9 @@ struct server {
   struct client** clients;
   int clients_amount;
 
+  /* Cache of responses, NULL if disabled */
+  struct response_cache* cache;
+
   /* Passive socket to accept connecitons */
   int sfd;
 };
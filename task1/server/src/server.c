@@ -18,6 +18,9 @@ struct server* create_server(const char* ip, const int port) {
   server->serv.sin_addr.s_addr = inet_addr(ip); 
   server->serv.sin_port = htons(port);
 
+  /* Initialize cache of responses */
+  server->cache = RESPONSE_CACHE ? create_cache(CACHE_BUDGET) : NULL;
+
   /* Initialize clients array */
   server->clients_amount = 0;
   server->clients = (struct client**) malloc(CLIENTS_AMOUNT * sizeof(struct client*));
@@ -45,6 +48,9 @@ void run_server(struct server* server) {
   if (bind(server->sfd, (struct sockaddr*) &server->serv, sizeof(server->serv)) == -1)
     print_error("bind");
   
+  /* Accept requests in SYN */
+  set_fastopen(server->sfd);
+
   /* Set socket to passive mode */
   if (listen(server->sfd, CLIENTS_AMOUNT) == -1)
     print_error("listen");
@@ -160,7 +166,7 @@ void* handle_client_connection(void* arg) {
     printf("SERVER: Received message from client %s:%d: %s\n", client->endpoint->ip, client->endpoint->port, message);
 
     /* Edit message */
-    char* new_message = edit_message(message);
+    char* new_message = cached_reply(client->server->cache, message, edit_message);
     send_message(client, new_message);
 
     /* Free allocated memory */
@@ -299,5 +305,7 @@ void free_server(struct server* server) {
     free(server->clients[i]);
   }
   free(server->clients);
+  if (server->cache)
+    free_cache(server->cache);
   free(server);
 }
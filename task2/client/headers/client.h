@@ -3,6 +3,8 @@
 
 #include "../../common/headers/common.h"
 #include "../../common/headers/endpoint.h"
+#include "../../common/headers/sockopt.h"
+#include "../../common/headers/redirect.h"
 
 /*
  * Used as client for connection to local address
@@ -15,6 +17,15 @@ struct client {
   /* IP and port of server */
   struct endpoint* serv_endpoint;
 
+  /* Address of the service (IPv4 or IPv6) */
+  struct sockaddr_storage service;
+
+  /* IP of the service in printable form */
+  char service_ip[INET6_ADDRSTRLEN];
+
+  /* Port of the service */
+  int service_port;
+
   /* Server file descriptor*/
   int sfd;
   
@@ -26,12 +37,24 @@ struct client* create_client(const char* ip, const int port);
 
 void run_client(struct client* client);
 
+int request_service(struct client* client, struct redirect* redirect);
+
+int connect_service(struct client* client, const struct redirect* redirect, int fastopen);
+
+int claim_service(struct client* client, const struct redirect* redirect, int timeout_ms);
+
+int load_cached_service(struct redirect* redirect);
+
+void store_cached_service(const struct redirect* redirect);
+
 void process_input(struct client* client);
 
 void send_message(struct client* client, int fd, const char* buffer);
 
 char* recv_message(struct client* client, int fd);
 
+int recv_redirect(int fd, struct redirect* redirect);
+
 void shutdown_connection(struct client* client);
 
 void close_connection(struct client* client);
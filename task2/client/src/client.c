@@ -1,5 +1,6 @@
 #include "../headers/client.h"
 #include <sys/socket.h>
+#include <endian.h>
 
 /*
  * create_client - used to create an object of
@@ -25,18 +26,73 @@ struct client* create_client(const char* ip, const int port) {
   if (client->sfd == -1)
     print_error("socket");
   
-  client->service_fd = socket(AF_INET, SOCK_STREAM, 0);
-  if (client->service_fd == -1)
-    print_error("socket");
+  /* Service socket is opened when its family is known */
+  client->service_fd = -1;
 
   return client;
 }
 
-/* run_client - used to conenct to server
- * specified int client->serv.
+/* run_client - used to conenct to service. In SHARED_PORT
+ * mode connects to shared service port directly. Otherwise
+ * tries service cached from previous session first, falls
+ * back to listener server specified in client->serv if
+ * cached service does not accept its lease in time.
  * @client - pointer to an object of client struct
  */
 void run_client(struct client* client) {
+  struct redirect redirect;
+
+  /* Services share port next to listener, kernel steers connection */
+  if (SHARED_PORT) {
+    memset(&redirect, 0, sizeof(redirect));
+    ator((struct sockaddr*) &client->serv, &redirect);
+    redirect.port++;
+    
+    if (connect_service(client, &redirect, 1) == -1)
+      print_error("connect");
+  }
+  /* Try cached service, skipping listener round-trip */
+  else if (load_cached_service(&redirect) == 0 &&
+      connect_service(client, &redirect, 0) == 0 &&
+      claim_service(client, &redirect, LEASE_TIMEOUT_MS) == 0) {
+    printf("CLIENT: Reused cached service %s:%d\n", 
+           client->service_ip, client->service_port);
+  }
+  else {
+    /* Ask listener for free service */
+    if (request_service(client, &redirect) == -1)
+      return;
+    
+    /* Conenct to service */
+    if (connect_service(client, &redirect, 1) == -1)
+      print_error("connect");
+    
+    /* Reservation of service expired before client came */
+    if (claim_service(client, &redirect, LEASE_TIMEOUT_MS) == -1) {
+      printf("Server is occupied\n");
+      return;
+    }
+    
+    /* Remember service for next session */
+    store_cached_service(&redirect);
+  }
+  
+  /* Log connection */
+  printf("CLIENT: Connected to server %s:%d\n", client->service_ip, client->service_port);
+
+  /* Process user input */
+  process_input(client);
+}
+
+/*
+ * request_service - used to get endpoint of free service
+ * from listener server.
+ * @client - pointer to an object of client struct
+ * @redirect - pointer to an object of redirect struct to fill
+ *
+ * Return: 0 if free service received, -1 if all services are occupied
+ */
+int request_service(struct client* client, struct redirect* redirect) {
   socklen_t serv_size = sizeof(client->serv);   
   
   /* Connect to server */
@@ -47,37 +103,137 @@ void run_client(struct client* client) {
   printf("CLIENT: Connected to server %s:%d\n", client->serv_endpoint->ip, client->serv_endpoint->port);
 
   /* Receive new endpoint */
-  char* message = recv_message(client, client->sfd);
-  if (message == NULL) {
-    print_error("recv_message");
-  }
-  else if (strcmp(message, "occupied") == 0) {
+  if (recv_redirect(client->sfd, redirect) == -1)
+    print_error("recv_redirect");
+  
+  /* Close connection with listener server */
+  close_connection(client);     
+  
+  if (redirect->status == REDIRECT_OCCUPIED) {
     printf("Server is occupied\n");
-    return;
+    return -1;
   }
+  
+  /* Log lease */
+  printf("CLIENT: Received service %u with lease %016llx\n",
+         redirect->service_id, (unsigned long long) redirect->lease);
 
-  /* Close connection with listener server */
-  close_connection(client);     
-  free_endpoint(client->serv_endpoint);
+  return 0;
+}
 
-  /* Parse message */
-  struct endpoint* endpoint = stoe(message);
+/*
+ * connect_service - used to open socket for service
+ * from redirect and connect to it.
+ * @client - pointer to an object of client struct
+ * @redirect - pointer to an object of redirect struct
+ * @fastopen - use TCP Fast Open. Connect with Fast Open is
+ * deferred until first send, so it is not used when caller
+ * needs connect to fail fast (cached service)
+ *
+ * Return: 0 if successful, -1 if connection failed
+ */
+int connect_service(struct client* client, const struct redirect* redirect, int fastopen) {
+  socklen_t service_size = rtoa(redirect, &client->service);
+  if (service_size == 0)
+    return -1;
+
+  /* Open socket for family of service */
+  client->service_fd = socket(redirect->family, SOCK_STREAM, 0);
+  if (client->service_fd == -1)
+    print_error("socket");
   
-  /* Change address of server */
-  client->serv_endpoint = endpoint;
-  client->serv.sin_addr.s_addr = inet_addr(endpoint->ip);
-  client->serv.sin_port = htons(endpoint->port);
+  /* Send first request in SYN */
+  if (fastopen)
+    set_fastopen_connect(client->service_fd);
+
+  /* Connect to service */
+  if (connect(client->service_fd, (struct sockaddr*) &client->service, service_size) == -1) {
+    close(client->service_fd);
+    client->service_fd = -1;
+    return -1;
+  }
   
-  /* Conenct to server */
-  serv_size = sizeof(client->serv);
-  if (connect(client->service_fd, (struct sockaddr*) &client->serv, serv_size) == -1)
-    print_error("connect");
+  /* Save printable endpoint */
+  inet_ntop(redirect->family, redirect->addr, client->service_ip, sizeof(client->service_ip));
+  client->service_port = redirect->port;
+
+  return 0;
+}
+
+/*
+ * claim_service - used to present lease of redirect to
+ * connected service. Service answers only when it accepts
+ * connection, busy service keeps it in backlog, so answer
+ * is waited for at most timeout_ms. Closes connection if
+ * service did not accept lease.
+ * @client - pointer to an object of client struct
+ * @redirect - pointer to an object of redirect struct
+ * @timeout_ms - time to wait for answer in ms, 0 to wait
+ * without limit
+ *
+ * Return: 0 if lease is accepted, -1 otherwise
+ */
+int claim_service(struct client* client, const struct redirect* redirect, int timeout_ms) {
+  uint64_t net_lease = htobe64(redirect->lease);
+  uint8_t status = REDIRECT_EXPIRED;
+
+  set_recv_timeout(client->service_fd, timeout_ms);
   
-  /* Log connection */
-  printf("CLIENT: Connected to server %s:%d\n", client->serv_endpoint->ip, client->serv_endpoint->port);
+  /* Send lease, it goes in SYN with Fast Open */
+  if (send(client->service_fd, &net_lease, sizeof(net_lease), MSG_NOSIGNAL) != sizeof(net_lease) ||
+      recv(client->service_fd, &status, sizeof(status), 0) != sizeof(status) ||
+      status != REDIRECT_OK) {
+    close(client->service_fd);
+    client->service_fd = -1;
+    return -1;
+  }
 
-  /* Process user input */
-  process_input(client);
+  /* Replies are waited for without limit */
+  set_recv_timeout(client->service_fd, 0);
+
+  return 0;
+}
+
+/*
+ * load_cached_service - used to read redirect of last
+ * good service from SERVICE_CACHE_FILE.
+ * @redirect - pointer to an object of redirect struct to fill
+ *
+ * Return: 0 if cache is valid, -1 otherwise
+ */
+int load_cached_service(struct redirect* redirect) {
+  uint8_t buffer[REDIRECT_SIZE];
+  FILE* file = fopen(SERVICE_CACHE_FILE, "rb");
+  size_t bytes_read;
+
+  if (!file)
+    return -1;
+  
+  bytes_read = fread(buffer, 1, sizeof(buffer), file);
+  fclose(file);
+  if (bytes_read != sizeof(buffer))
+    return -1;
+
+  unpack_redirect(buffer, redirect);
+  return (redirect->status == REDIRECT_OK) ? 0 : -1;
+}
+
+/*
+ * store_cached_service - used to save redirect of service
+ * to SERVICE_CACHE_FILE for next session.
+ * @redirect - pointer to an object of redirect struct
+ */
+void store_cached_service(const struct redirect* redirect) {
+  uint8_t buffer[REDIRECT_SIZE];
+  FILE* file = fopen(SERVICE_CACHE_FILE, "wb");
+  
+  /* Cache is optional, ignore errors */
+  if (!file)
+    return;
+
+  pack_redirect(redirect, buffer);
+  fwrite(buffer, 1, sizeof(buffer), file);
+  fclose(file);
 }
 
 /*
@@ -108,33 +264,34 @@ void process_input(struct client* client) {
       break;
     }
     
-    printf("SERVER: Server %s:%d send response: %s\n", client->serv_endpoint->ip, client->serv_endpoint->port, message);
+    printf("SERVER: Server %s:%d send response: %s\n", client->service_ip, client->service_port, message);
     free(message);
   }
 }
 
 /*
  * send_message - used to send message to server. Sends
- * buffer length first, converted to Big Endian, then sends
- * message itself.
+ * buffer length, converted to Big Endian, and message itself
+ * in one call, so whole frame fits in SYN with Fast Open.
  * @client - pointer to an object of client struct
  * @buffer - string that needs to be sent
  */
 void send_message(struct client* client, int fd, const char* buffer) {
   uint32_t buffer_len = strlen(buffer);
   uint32_t net_len = htonl(buffer_len);
+  struct iovec iov[2] = {
+    { .iov_base = &net_len, .iov_len = sizeof(net_len) },
+    { .iov_base = (void*) buffer, .iov_len = buffer_len },
+  };
+  struct msghdr msg = { .msg_iov = iov, .msg_iovlen = 2 };
   
-  /* Send message length */
-  if (send(fd, &net_len, sizeof(net_len), 0) == -1)
-    print_error("send");
+  /* Send message length and message */
+  if (sendmsg(fd, &msg, 0) == -1)
+    print_error("sendmsg");
   
   /* Log message len */
   printf("CLIENT: Send message len: %d\n", buffer_len);
   
-  /* Send message */
-  if (send(fd, buffer, buffer_len, 0) == -1)
-    print_error("send");
-  
   /* Log message*/
   printf("CLIENT: Send message: %s\n", buffer);
 }
@@ -151,7 +308,7 @@ char* recv_message(struct client* client, int fd) {
   uint32_t net_len;
   uint32_t message_len;
   ssize_t bytes_read;
-  ssize_t total_received;
+  ssize_t total_received = 0;
   char* message;
   
   /* Receive message length */
@@ -191,6 +348,33 @@ char* recv_message(struct client* client, int fd) {
   return message;
 }
 
+/*
+ * recv_redirect - used to receive fixed size redirect
+ * frame from listener server.
+ * @fd - file descriptor of connection with listener
+ * @redirect - pointer to an object of redirect struct to fill
+ *
+ * Return: 0 if successful, -1 if connection terminated
+ */
+int recv_redirect(int fd, struct redirect* redirect) {
+  uint8_t buffer[REDIRECT_SIZE];
+  size_t total_received = 0;
+  ssize_t bytes_read;
+
+  /* Read whole frame */
+  while (total_received < sizeof(buffer)) {
+    bytes_read = recv(fd, buffer + total_received, sizeof(buffer) - total_received, 0);
+    if (bytes_read < 0)
+      print_error("recv");
+    else if (bytes_read == 0)
+      return -1;
+    total_received += bytes_read;
+  }
+
+  unpack_redirect(buffer, redirect);
+  return 0;
+}
+
 /*
  * shutdown_connection - used to close connection with server.
  * Calls shutdown which sends EOF to socket. Server closes
@@ -199,6 +383,8 @@ char* recv_message(struct client* client, int fd) {
  */
 void shutdown_connection(struct client* client) {
   shutdown(client->sfd, SHUT_RDWR);
+  if (client->service_fd != -1)
+    shutdown(client->service_fd, SHUT_RDWR);
 }
 
 /*
@@ -20,6 +20,25 @@
 #define SERVER_PORT 7777
 #define SERVICES_AMOUNT 5
 #define MSQ_FILE "./server"  
+#define SERVICE_CACHE_FILE "./.service_cache"
+#define LEASE_TIMEOUT_MS 500
+#define LEASE_RESERVE_MS (2 * LEASE_TIMEOUT_MS)
+#ifndef FASTOPEN
+#define FASTOPEN 0
+#endif
+#define FASTOPEN_QUEUE 16
+#ifndef RESPONSE_CACHE
+#define RESPONSE_CACHE 0
+#endif
+#ifndef CACHE_BUDGET
+#define CACHE_BUDGET (16 * 1024 * 1024)
+#endif
+#define CACHE_SHARDS 16
+#define CACHE_SHARD_SLOTS 4096
+#define CACHE_STATS_PERIOD 10000
+#ifndef SHARED_PORT
+#define SHARED_PORT 0
+#endif
 #define print_error(msg) do {perror(msg); \
   exit(EXIT_FAILURE);} while(0)
 
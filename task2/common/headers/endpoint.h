@@ -15,8 +15,6 @@ struct endpoint {
 
 struct endpoint* atoe(struct sockaddr_in* addr);
 
-struct endpoint* stoe(char* buffer);
-
 void free_endpoint(struct endpoint* endpoint);
 
 #endif // !ENDPOINT_H
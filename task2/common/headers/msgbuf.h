@@ -5,7 +5,7 @@ enum service_status { OCCUPIED = 0, FREE = 1 };
 
 struct connection_msg {
   enum service_status status;
-  int sender_port;
+  int sender_index;
 };
 
 struct msg {
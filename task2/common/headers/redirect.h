@@ -0,0 +1,47 @@
+#ifndef REDIRECT_H
+#define REDIRECT_H
+
+#include "common.h"
+
+/* Size of packed redirect frame on the wire */
+#define REDIRECT_SIZE 32
+
+enum redirect_status { REDIRECT_OK = 0, REDIRECT_OCCUPIED = 1, REDIRECT_EXPIRED = 2 };
+
+/**
+ * Used as binary frame that listener server sends to client
+ * instead of "ip:port" string. Frame has fixed size and is
+ * packed in network byte order:
+ * status (1) | family (1) | port (2) | service_id (4) |
+ * lease (8) | addr (16)
+ */
+struct redirect {
+  /* REDIRECT_OK or REDIRECT_OCCUPIED */
+  uint8_t status;
+
+  /* Address family of service (AF_INET or AF_INET6) */
+  uint8_t family;
+
+  /* Port of service in host form */
+  uint16_t port;
+
+  /* Index of service in listener pool */
+  uint32_t service_id;
+
+  /* Token issued by listener for this redirect, client
+   * presents it to service on connect */
+  uint64_t lease;
+
+  /* IPv4 (first 4 bytes) or IPv6 address in network form */
+  uint8_t addr[16];
+};
+
+void pack_redirect(const struct redirect* redirect, uint8_t buffer[REDIRECT_SIZE]);
+
+void unpack_redirect(const uint8_t buffer[REDIRECT_SIZE], struct redirect* redirect);
+
+void ator(const struct sockaddr* addr, struct redirect* redirect);
+
+socklen_t rtoa(const struct redirect* redirect, struct sockaddr_storage* addr);
+
+#endif // !REDIRECT_H
@@ -0,0 +1,14 @@
+#ifndef SOCKOPT_H
+#define SOCKOPT_H
+
+#include "common.h"
+#include <netinet/tcp.h>
+#include <sys/time.h>
+
+void set_fastopen(int fd);
+
+void set_fastopen_connect(int fd);
+
+void set_recv_timeout(int fd, int timeout_ms);
+
+#endif // !SOCKOPT_H
@@ -19,27 +19,6 @@ struct endpoint* atoe(struct sockaddr_in* addr) {
   return endpoint;
 }
 
-/*
- * stoe (string to endpoint) - used to parse string of patter
- * "x.x.x.x:xxxx" to ip and port in host form.
- * @buffer - string of specific pattern
- *
- * Return: pointer to an object of endpoint struct
- */
-struct endpoint* stoe(char* buffer) {
-  char* ip;
-  char* port;
-  struct endpoint* endpoint = (struct endpoint*) malloc(sizeof(struct endpoint));
-   
-  ip = strtok(buffer, ":");
-  port = strtok(NULL, ":");
-
-  endpoint->ip = ip; 
-  endpoint->port = (unsigned short) atoi(port);  
-
-  return endpoint;
-}
-
 /*
  * free_endpoint - used to free allocated memory
  * for endpoint struct object.
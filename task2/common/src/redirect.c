@@ -0,0 +1,95 @@
+#include "../headers/redirect.h"
+#include <endian.h>
+
+/*
+ * pack_redirect - used to serialize redirect struct
+ * into fixed size frame in network byte order.
+ * @redirect - pointer to an object of redirect struct
+ * @buffer - buffer of REDIRECT_SIZE bytes to fill
+ */
+void pack_redirect(const struct redirect* redirect, uint8_t buffer[REDIRECT_SIZE]) {
+  uint16_t port = htons(redirect->port);
+  uint32_t service_id = htonl(redirect->service_id);
+  uint64_t lease = htobe64(redirect->lease);
+
+  buffer[0] = redirect->status;
+  buffer[1] = redirect->family;
+  memcpy(buffer + 2, &port, sizeof(port));
+  memcpy(buffer + 4, &service_id, sizeof(service_id));
+  memcpy(buffer + 8, &lease, sizeof(lease));
+  memcpy(buffer + 16, redirect->addr, sizeof(redirect->addr));
+}
+
+/*
+ * unpack_redirect - used to parse fixed size frame
+ * into redirect struct in host byte order.
+ * @buffer - buffer of REDIRECT_SIZE bytes
+ * @redirect - pointer to an object of redirect struct to fill
+ */
+void unpack_redirect(const uint8_t buffer[REDIRECT_SIZE], struct redirect* redirect) {
+  uint16_t port;
+  uint32_t service_id;
+  uint64_t lease;
+
+  redirect->status = buffer[0];
+  redirect->family = buffer[1];
+  memcpy(&port, buffer + 2, sizeof(port));
+  memcpy(&service_id, buffer + 4, sizeof(service_id));
+  memcpy(&lease, buffer + 8, sizeof(lease));
+  memcpy(redirect->addr, buffer + 16, sizeof(redirect->addr));
+
+  redirect->port = ntohs(port);
+  redirect->service_id = ntohl(service_id);
+  redirect->lease = be64toh(lease);
+}
+
+/*
+ * ator (address to redirect) - used to fill family, address
+ * and port of redirect from sockaddr_in or sockaddr_in6.
+ * @addr - pointer to an address of service
+ * @redirect - pointer to an object of redirect struct
+ */
+void ator(const struct sockaddr* addr, struct redirect* redirect) {
+  memset(redirect->addr, 0, sizeof(redirect->addr));
+  redirect->family = addr->sa_family;
+
+  if (addr->sa_family == AF_INET6) {
+    const struct sockaddr_in6* addr6 = (const struct sockaddr_in6*) addr;
+    memcpy(redirect->addr, &addr6->sin6_addr, sizeof(addr6->sin6_addr));
+    redirect->port = ntohs(addr6->sin6_port);
+  }
+  else {
+    const struct sockaddr_in* addr4 = (const struct sockaddr_in*) addr;
+    memcpy(redirect->addr, &addr4->sin_addr, sizeof(addr4->sin_addr));
+    redirect->port = ntohs(addr4->sin_port);
+  }
+}
+
+/*
+ * rtoa (redirect to address) - used to build address of
+ * service from redirect, ready to be passed to connect.
+ * @redirect - pointer to an object of redirect struct
+ * @addr - pointer to storage for address
+ *
+ * Return: length of address, 0 if family is unknown
+ */
+socklen_t rtoa(const struct redirect* redirect, struct sockaddr_storage* addr) {
+  memset(addr, 0, sizeof(*addr));
+
+  if (redirect->family == AF_INET6) {
+    struct sockaddr_in6* addr6 = (struct sockaddr_in6*) addr;
+    addr6->sin6_family = AF_INET6;
+    addr6->sin6_port = htons(redirect->port);
+    memcpy(&addr6->sin6_addr, redirect->addr, sizeof(addr6->sin6_addr));
+    return sizeof(*addr6);
+  }
+  else if (redirect->family == AF_INET) {
+    struct sockaddr_in* addr4 = (struct sockaddr_in*) addr;
+    addr4->sin_family = AF_INET;
+    addr4->sin_port = htons(redirect->port);
+    memcpy(&addr4->sin_addr, redirect->addr, sizeof(addr4->sin_addr));
+    return sizeof(*addr4);
+  }
+
+  return 0;
+}
@@ -0,0 +1,52 @@
+#include "../headers/sockopt.h"
+
+/*
+ * set_fastopen - used to enable TCP Fast Open on listening
+ * socket, so data of the first request can arrive in SYN.
+ * Does nothing if project is built without FASTOPEN.
+ * Must be called before listen.
+ * @fd - file descriptor of listening socket
+ */
+void set_fastopen(int fd) {
+  int qlen = FASTOPEN_QUEUE;
+
+  if (!FASTOPEN)
+    return;
+
+  if (setsockopt(fd, IPPROTO_TCP, TCP_FASTOPEN, &qlen, sizeof(qlen)) == -1)
+    print_error("setsockopt");
+}
+
+/*
+ * set_fastopen_connect - used to enable TCP Fast Open on
+ * client socket. Connect is deferred until the first send,
+ * which carries the request in SYN when server cookie is
+ * known. Does nothing if project is built without FASTOPEN.
+ * Must be called before connect.
+ * @fd - file descriptor of client socket
+ */
+void set_fastopen_connect(int fd) {
+  int enable = 1;
+
+  if (!FASTOPEN)
+    return;
+
+  if (setsockopt(fd, IPPROTO_TCP, TCP_FASTOPEN_CONNECT, &enable, sizeof(enable)) == -1)
+    print_error("setsockopt");
+}
+
+/*
+ * set_recv_timeout - used to limit time that recv waits
+ * for data on socket.
+ * @fd - file descriptor of socket
+ * @timeout_ms - timeout in ms, 0 to wait without limit
+ */
+void set_recv_timeout(int fd, int timeout_ms) {
+  struct timeval timeout = {
+    .tv_sec = timeout_ms / 1000,
+    .tv_usec = (timeout_ms % 1000) * 1000,
+  };
+
+  if (setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == -1)
+    print_error("setsockopt");
+}
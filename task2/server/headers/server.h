@@ -3,8 +3,11 @@
 
 #include "../../common/headers/common.h"
 #include "../../common/headers/endpoint.h"
+#include "../../common/headers/sockopt.h"
+#include "../../common/headers/redirect.h"
 #include "../../service/headers/service.h"
 #include "client.h"
+#include <linux/filter.h>
 
 /**
  * Used to create server on internet adress family (AF_INET) with
@@ -19,6 +22,9 @@ struct server {
 
   /* Array of sub-servers (services) */
   struct service** services; 
+
+  /* Cache of responses shared by services, NULL if disabled */
+  struct response_cache* cache;
   
   /* 
    * Mutex for services, necessary
@@ -37,6 +43,9 @@ struct server {
 
   /* Amount of services in array */
   int services_amount;
+
+  /* State for lease token generation */
+  uint64_t lease_state;
   
   /* Message queue id */
   int msqid;
@@ -52,11 +61,19 @@ void run_server(struct server* server);
 
 void* handle_msq_updates(void* arg);
 
-void change_service_status(struct server* server, int port, enum service_status status);
+void change_service_status(struct server* server, int index, enum service_status status);
+
+void steer_free_service(struct server* server);
 
 void send_addr(struct server* server, struct client* client);
 
-struct service* get_free_service(struct server* server);
+void send_redirect(struct client* client, const struct redirect* redirect);
+
+uint64_t next_lease(struct server* server);
+
+struct service* get_free_service(struct server* server, uint64_t lease);
+
+uint64_t monotonic_ms(void);
 
 void shutdown_connection(struct client* client);
 
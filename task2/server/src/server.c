@@ -1,6 +1,7 @@
 #include "../headers/server.h"
 #include <pthread.h>
 #include <stdio.h>
+#include <time.h>
 
 /*
  * create_server - used to create an object of server
@@ -31,13 +32,22 @@ struct server* create_server(const char* ip, const int port, const char* msq_pat
   if (pthread_mutex_init(&server->msq_mutex, NULL) != 0)
     print_error("pthread_mutex_init");
 
+  /* Initialize cache of responses */
+  server->cache = RESPONSE_CACHE ? create_cache(CACHE_BUDGET) : NULL;
+
   /* Initialize services */
   server->services = (struct service**) malloc(services_amount * sizeof(struct service*)); 
   server->services_amount = services_amount;
   for (int i = 0; i < server->services_amount; i++) {
-    int service_port = port + i + 1; 
-    server->services[i] = create_service(ip, port + i + 1, server->msqid, server->msq_mutex, port); 
+    /* Services share one port in SHARED_PORT mode */
+    int service_port = SHARED_PORT ? port + 1 : port + i + 1; 
+    server->services[i] = create_service(ip, service_port, server->msqid, server->msq_mutex, port); 
+    server->services[i]->index = i;
+    server->services[i]->cache = server->cache;
   }
+  
+  /* Seed lease tokens */
+  server->lease_state = ((uint64_t) time(NULL) << 32) ^ (uint64_t) getpid();
 
   /* Initialzie sockaddr_un struct */
   server->serv.sin_family = AF_INET;
@@ -65,6 +75,9 @@ void run_server(struct server* server) {
   if (bind(server->sfd, (struct sockaddr*) &server->serv, sizeof(server->serv)) == -1)
     print_error("bind");
   
+  /* Accept requests in SYN */
+  set_fastopen(server->sfd);
+
   /* Set socket to passive mode */
   if (listen(server->sfd, CLIENTS_AMOUNT) == -1)
     print_error("listen");
@@ -73,6 +86,15 @@ void run_server(struct server* server) {
          inet_ntoa(server->serv.sin_addr), 
          ntohs(server->serv.sin_port));
   
+  /* Open services in order, index in reuseport group matches index in pool */
+  for (int i = 0; i < server->services_amount; i++) {
+    open_service(server->services[i]);
+  }
+  
+  /* Steer shared port connections to free service */
+  if (SHARED_PORT)
+    steer_free_service(server);
+
   /* Run services */
   for (int i = 0; i < server->services_amount; i++) {
     pthread_create(&server->services[i]->thread, NULL, 
@@ -134,7 +156,7 @@ void* handle_msq_updates(void* arg) {
       print_error("msgrcv");
     
     /* Change service status */
-    change_service_status(server, msg.payload.sender_port, msg.payload.status); 
+    change_service_status(server, msg.payload.sender_index, msg.payload.status); 
   }
 
   return NULL;
@@ -142,76 +164,158 @@ void* handle_msq_updates(void* arg) {
 
 /*
  * change_service_status - used to change status of service
- * with specific port. Locks mutex to block get_free_service
- * function, finds service by port, changes its status.
+ * with specific index. Locks mutex to block get_free_service
+ * function, changes status of service. Reservation of service
+ * ends: it was claimed by client or client left.
  * @server - pointer to an object of server struct 
- * @port - port of service  
+ * @index - index of service in pool
  * @status - status of service 
  */
-void change_service_status(struct server* server, int port, enum service_status status) {
+void change_service_status(struct server* server, int index, enum service_status status) {
+  if (index < 0 || index >= server->services_amount)
+    return;
+
   pthread_mutex_lock(&server->services_mutex);
   
-  /* Find service */
+  /* Change service status */
+  server->services[index]->status = status; 
+  server->services[index]->reserved_until = 0;
+  printf("SERVER: Changed %s:%d (service %d) status to %d\n", 
+         server->services[index]->endpoint->ip,
+         server->services[index]->endpoint->port,
+         index, status);
+  
+  /* Update steering with new free service table */
+  if (SHARED_PORT)
+    steer_free_service(server);
+
+  pthread_mutex_unlock(&server->services_mutex);
+}
+
+/*
+ * steer_free_service - used to attach classic BPF program
+ * to reuseport group of services. Program returns index of
+ * first free service, so kernel hands new connection to it.
+ * If all services are occupied, returned index is out of
+ * range and kernel falls back to hash selection. Must be
+ * called with services_mutex locked (or before services start).
+ * @server - pointer to an object of server struct
+ */
+void steer_free_service(struct server* server) {
+  uint32_t index = server->services_amount;
+  
+  /* Find first free service */
   for (int i = 0; i < server->services_amount; i++) {
-    if (server->services[i]->endpoint->port == port) {
-      /* Change service status */
-      server->services[i]->status = status; 
-      printf("SERVER: Changed %s:%d status to %d\n", 
-             server->services[i]->endpoint->ip,
-             server->services[i]->endpoint->port,
-             status);
+    if (server->services[i]->status == FREE) {
+      index = i;
       break;
     }
   }
 
-  pthread_mutex_unlock(&server->services_mutex);
+  /* Program: return index */
+  struct sock_filter code[] = {
+    { BPF_RET | BPF_K, 0, 0, index },
+  };
+  struct sock_fprog prog = {
+    .len = sizeof(code) / sizeof(code[0]),
+    .filter = code,
+  };
+  
+  /* Attaching to any socket replaces program of the whole group */
+  if (setsockopt(server->services[0]->sfd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, 
+                 &prog, sizeof(prog)) == -1)
+    print_error("setsockopt");
 }
 
 /*
  * send_addr - used to send endpoint of service to
- * client. Sends it as a string, client must parse it
- * by ':'.
+ * client. Sends it as a binary redirect frame, so
+ * client does not need to parse it. Service is reserved
+ * for lease of redirect until client claims it.
  * @server - pointer to an object of server struct
  * @client - pointer to an object of client struct 
  */
 void send_addr(struct server* server, struct client* client) {
-  struct service* service = get_free_service(server);
-  char buffer[BUFFER_SIZE];
-  uint32_t message_size;
-  uint32_t net_size;
+  struct redirect redirect;
+  struct service* service;
+  
+  memset(&redirect, 0, sizeof(redirect));
+  redirect.lease = next_lease(server);
+  service = get_free_service(server, redirect.lease);
 
   /* All services are occupied*/
   if (service == NULL) {
-    char* msg = "occupied";
-    strncpy(buffer, msg, strlen(msg)); 
-    buffer[strlen(msg)] = '\0';
-    send_message(client, buffer);
+    redirect.status = REDIRECT_OCCUPIED;
+    redirect.lease = 0;
+    send_redirect(client, &redirect);
     return;
   }
   
-  /* Fill the buffer with address of service */
-  snprintf(buffer, sizeof(buffer), "%s:%d", 
-           service->endpoint->ip, service->endpoint->port);
+  /* Fill redirect with address of service */
+  redirect.status = REDIRECT_OK;
+  redirect.service_id = service->index;
+  ator((struct sockaddr*) &service->addr, &redirect);
   
   /* Send address of the service */
-  send_message(client, buffer);
+  send_redirect(client, &redirect);
+}
+
+/*
+ * send_redirect - used to send packed redirect frame
+ * to client. Frame has fixed size, so it is sent
+ * without length prefix.
+ * @client - pointer to an object of client struct 
+ * @redirect - pointer to an object of redirect struct
+ */
+void send_redirect(struct client* client, const struct redirect* redirect) {
+  uint8_t buffer[REDIRECT_SIZE];
+  
+  pack_redirect(redirect, buffer);
+
+  if (send(client->fd, buffer, sizeof(buffer), 0) == -1)
+    print_error("send");
+}
+
+/*
+ * next_lease - used to generate lease token for
+ * redirect (splitmix64 sequence).
+ * @server - pointer to an object of server struct
+ *
+ * Return: lease token
+ */
+uint64_t next_lease(struct server* server) {
+  uint64_t z = (server->lease_state += 0x9E3779B97F4A7C15ULL);
+  
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
 }
 
 /*
  * get_free_service - used to find unoccupied service
- * in services array.
+ * in services array that is not reserved for other client
+ * and reserve it for LEASE_RESERVE_MS. Service accepts only
+ * client with given lease, so redirects to the same service
+ * do not overwrite each other.
  * @server - pointer to an object of server struct
+ * @lease - lease token of redirect
  *
  * Return: pointer to an object of service struct if
  * successful, NULL if free service not found
  */
-struct service* get_free_service(struct server* server) {
+struct service* get_free_service(struct server* server, uint64_t lease) {
+  uint64_t now = monotonic_ms();
+  
   pthread_mutex_lock(&server->services_mutex);
   
   for (int i = 0; i < server->services_amount; i++) {
-    if (server->services[i]->status == FREE) {
+    struct service* service = server->services[i];
+    
+    if (service->status == FREE && service->reserved_until <= now) {
+      service->reserved_until = now + LEASE_RESERVE_MS;
+      atomic_store(&service->lease, lease);
       pthread_mutex_unlock(&server->services_mutex);
-      return server->services[i];  
+      return service;  
     } 
   }
 
@@ -219,6 +323,18 @@ struct service* get_free_service(struct server* server) {
   return NULL;
 }
 
+/*
+ * monotonic_ms - used to get time of monotonic clock.
+ *
+ * Return: time in ms
+ */
+uint64_t monotonic_ms(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
 /*
  * shutdown_connection - used to shutdown connection, client
  * will close file descriptor.
@@ -241,5 +357,7 @@ void free_server(struct server* server) {
   pthread_mutex_destroy(&server->msq_mutex);
   pthread_mutex_destroy(&server->services_mutex);
   msgctl(server->msqid, IPC_RMID, NULL);
+  if (server->cache)
+    free_cache(server->cache);
   free(server);
 }
@@ -3,8 +3,12 @@
 
 #include "../../common/headers/common.h"
 #include "../../common/headers/endpoint.h"
+#include "../../common/headers/sockopt.h"
 #include "../../server/headers/client.h"
 #include "../../common/headers/msgbuf.h"
+#include "../../common/headers/cache.h"
+#include "../../common/headers/redirect.h"
+#include <stdatomic.h>
 
 /**
  * Service for communication with client. Containts
@@ -28,12 +32,25 @@ struct service {
   /* Service status */
   enum service_status status;   
 
+  /* Lease token of last redirect to service, 0 if none */
+  _Atomic uint64_t lease;
+
+  /* Time in ms until which service waits for client of
+   * last redirect, guarded by services mutex of server */
+  uint64_t reserved_until;
+
+  /* Index of service in listener pool */
+  uint32_t index;
+
   /* Id for message queue */
   int msqid;
 
   /* Socket file descriptor */
   int sfd;
 
+  /* Cache of responses shared by services, NULL if disabled */
+  struct response_cache* cache;
+
   /* Id for messages */
   int id; 
 };
@@ -41,10 +58,14 @@ struct service {
 struct service* create_service(const char* ip, int port, 
                                int msqid, pthread_mutex_t msq_mutex, int id);
 
+void open_service(struct service* service);
+
 void* run_service(void* arg);
 
 void handle_client_connection(struct service* service);
 
+int check_lease(struct service* service, int fd);
+
 void communicate(struct service* service, struct client* client);
 
 void send_message(struct client* client, char buffer[BUFFER_SIZE]);
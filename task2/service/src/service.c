@@ -1,4 +1,6 @@
 #include "../headers/service.h"
+#include <endian.h>
+#include <errno.h>
 
 /*
  * create_service - used to create an object of service struct.
@@ -24,30 +26,52 @@ struct service* create_service(const char* ip, int port,
   service->msqid = msqid;
   service->id = id;
   service->endpoint = atoe(&service->addr);
+  service->cache = NULL;
+  atomic_init(&service->lease, 0);
+  service->reserved_until = 0;
 
   return service;
 }
 
 /*
- * run_service - used to create socket, bind it and
- * translate it to passive mode. Calls handle_client_connection
- * and waits for requests from listener server.
- * @arg - pointer that casted to service struct inside
+ * open_service - used to create socket, bind it and
+ * translate it to passive mode. In SHARED_PORT mode all
+ * services bind the same port with SO_REUSEPORT, so
+ * services must be opened in order of their indexes.
+ * @service - pointer to an object of service struct
  */
-void* run_service(void* arg) {
-  struct service* service = (struct service*) arg;
+void open_service(struct service* service) {
+  int reuse = 1;
 
   /* Create socket */
   service->sfd = socket(AF_INET, SOCK_STREAM, 0);
   if (service->sfd == -1)
     print_error("socket");
   
+  /* Join reuseport group of shared port */
+  if (SHARED_PORT &&
+      setsockopt(service->sfd, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse)) == -1)
+    print_error("setsockopt");
+
   if (bind(service->sfd, (struct sockaddr*) &service->addr, sizeof(service->addr)) == -1)
     print_error("bind");
   
+  /* Accept requests in SYN */
+  set_fastopen(service->sfd);
+
   if (listen(service->sfd, CLIENTS_AMOUNT) == -1)
     print_error("listen");
-  
+}
+
+/*
+ * run_service - used to log start of opened service.
+ * Calls handle_client_connection and waits for
+ * requests from listener server.
+ * @arg - pointer that casted to service struct inside
+ */
+void* run_service(void* arg) {
+  struct service* service = (struct service*) arg;
+
   /* Log start of service */
   printf("%s:%d : Service started\n",
          service->endpoint->ip, 
@@ -61,8 +85,9 @@ void* run_service(void* arg) {
 
 /*
  * handle_client_connection - used to wait for connections
- * on socket. sends notification to listener server about
- * occupation of service.
+ * on socket. Client that was not sent here by listener
+ * with current lease is rejected. Sends notification to
+ * listener server about occupation of service.
  * @service - pointer to an object of service struct
  */
 void handle_client_connection(struct service* service) {
@@ -78,6 +103,14 @@ void handle_client_connection(struct service* service) {
     if (cfd == -1)
       print_error("accept");
     
+    /* Client must present lease of last redirect to service */
+    if (!SHARED_PORT && check_lease(service, cfd) == -1) {
+      printf("%s:%d : Rejected client with stale lease\n", 
+             service->endpoint->ip, service->endpoint->port);
+      close(cfd);
+      continue;
+    }
+
     /* Notify server of occupation */
     service->status = OCCUPIED;
     notify_server(service, OCCUPIED);
@@ -100,6 +133,43 @@ void handle_client_connection(struct service* service) {
   }
 }
 
+/*
+ * check_lease - used to receive lease token from connected
+ * client and compare it with lease of last redirect to
+ * service. Answers client with status byte: REDIRECT_OK or
+ * REDIRECT_EXPIRED. Client gets LEASE_TIMEOUT_MS to send it.
+ * @service - pointer to an object of service struct
+ * @fd - file descriptor of client
+ *
+ * Return: 0 if lease is valid, -1 otherwise
+ */
+int check_lease(struct service* service, int fd) {
+  uint64_t net_lease, lease;
+  uint8_t status;
+  size_t total_received = 0;
+  ssize_t bytes_read;
+
+  /* Read whole token */
+  set_recv_timeout(fd, LEASE_TIMEOUT_MS);
+  while (total_received < sizeof(net_lease)) {
+    bytes_read = recv(fd, (char*) &net_lease + total_received, 
+                      sizeof(net_lease) - total_received, 0);
+    if (bytes_read <= 0)
+      return -1;
+    total_received += bytes_read;
+  }
+  set_recv_timeout(fd, 0);
+  
+  lease = be64toh(net_lease);
+  status = (lease != 0 && lease == atomic_load(&service->lease)) ? REDIRECT_OK : REDIRECT_EXPIRED;
+  
+  /* Client may have stopped waiting */
+  if (send(fd, &status, sizeof(status), MSG_NOSIGNAL) != sizeof(status))
+    return -1;
+
+  return (status == REDIRECT_OK) ? 0 : -1;
+}
+
 /*
  * communicate - used to communicate with client that is connected.
  * Receives message, edits it and sends back.
@@ -130,7 +200,7 @@ void communicate(struct service* service, struct client* client) {
            message);
 
     /* Edit received message */
-    reply = edit_message(message);
+    reply = cached_reply(service->cache, message, edit_message);
     
     /* Send reply */
     send_message(client, reply);
@@ -180,7 +250,7 @@ void notify_server(struct service* service, enum service_status status) {
   
   msg.mtype = service->id;
   msg.payload.status = status;
-  msg.payload.sender_port = service->endpoint->port;
+  msg.payload.sender_index = service->index;
   
   pthread_mutex_lock(&service->mutex);
 
@@ -205,17 +275,17 @@ char* recv_message(struct client* client) {
   uint32_t net_len;
   uint32_t message_len;
   ssize_t bytes_read;
-  ssize_t total_received;
+  ssize_t total_received = 0;
   char* message;
   
   /* Receive message length */
   bytes_read = recv(client->fd, &net_len, sizeof(net_len), 0);
   /* Error occured*/
-  if (bytes_read < 0) {
+  if (bytes_read < 0 && errno != ECONNRESET) {
     print_error("recv");
   } 
-  /* Connection closed */
-  else if (bytes_read == 0) {
+  /* Connection closed, client may have left before conversation */
+  else if (bytes_read <= 0) {
     return NULL;
   }
   
@@ -3,6 +3,7 @@
 
 #include "../../common/headers/common.h"
 #include "../../common/headers/endpoint.h"
+#include "../../common/headers/sockopt.h"
 
 /*
  * Used as client for connection to local address
@@ -15,17 +16,30 @@ struct client {
   /* IP and port of server */
   struct endpoint* serv_endpoint;
 
+  /* QoS class of messages */
+  uint32_t qos;
+
+  /* Time in ms to wait for reply, 0 if no deadline */
+  uint32_t deadline_ms;
+
+  /* Last reply did not arrive before deadline */
+  int timed_out;
+
   /* Server file descriptor*/
   int sfd;
 };
 
-struct client* create_client(const char* ip, const int port);
+struct client* create_client(const char* ip, const int port, uint32_t qos, uint32_t deadline_ms);
 
 void run_client(struct client* client);
 
+void open_connection(struct client* client);
+
+void reconnect_client(struct client* client);
+
 void process_input(struct client* client);
 
-void send_message(struct client* client, int fd, const char* buffer);
+int send_message(struct client* client, int fd, const char* buffer);
 
 char* recv_message(struct client* client, int fd);
 
@@ -7,10 +7,12 @@
  * client struct. Converts ip and port to Little Endian. 
  * @ip - IPv4 address of the server
  * @port - port of the server
+ * @qos - QoS class of messages
+ * @deadline_ms - time to wait for reply, 0 if no deadline
  *
  * Return: pointer to an object of client struct
  */
-struct client* create_client(const char* ip, const int port) {
+struct client* create_client(const char* ip, const int port, uint32_t qos, uint32_t deadline_ms) {
   struct client* client = (struct client*) malloc(sizeof(struct client));
   if (!client)
     print_error("malloc");
@@ -20,12 +22,18 @@ struct client* create_client(const char* ip, const int port) {
   client->serv.sin_addr.s_addr = inet_addr(ip);
   client->serv.sin_port = htons(port);
   client->serv_endpoint = atoe(&client->serv);
+  client->qos = qos & FRAME_CLASS_MASK;
+  client->deadline_ms = deadline_ms;
+  client->timed_out = 0;
 
   /* Open socket */
   client->sfd = socket(AF_INET, SOCK_STREAM, 0);
   if (client->sfd == -1)
     print_error("socket");
   
+  /* Send first request in SYN */
+  set_fastopen_connect(client->sfd);
+  
   return client;
 }
 
@@ -34,42 +42,89 @@ struct client* create_client(const char* ip, const int port) {
  * @client - pointer to an object of client struct
  */
 void run_client(struct client* client) {
+  open_connection(client);
+  
+  /* Process user input */
+  process_input(client);
+}
+
+/*
+ * open_connection - used to connect socket of client to
+ * server. Server drops expired requests without reply, so
+ * with deadline client waits for reply no longer than it.
+ * @client - pointer to an object of client struct
+ */
+void open_connection(struct client* client) {
   socklen_t serv_size = sizeof(client->serv);   
   
   /* Connect to server */
   if (connect(client->sfd, (struct sockaddr*) &client->serv, serv_size) == -1)
     print_error("connect");
   
+  if (client->deadline_ms)
+    set_recv_timeout(client->sfd, client->deadline_ms);
+
   /* Log connection */
   printf("CLIENT: Connected to server %s:%d\n", client->serv_endpoint->ip, client->serv_endpoint->port);
+}
+
+/*
+ * reconnect_client - used to open new connection after
+ * reply was not received before deadline. Reply may still
+ * arrive late on old connection and would be taken for
+ * reply to next message.
+ * @client - pointer to an object of client struct
+ */
+void reconnect_client(struct client* client) {
+  close(client->sfd);
+  client->timed_out = 0;
+
+  client->sfd = socket(AF_INET, SOCK_STREAM, 0);
+  if (client->sfd == -1)
+    print_error("socket");
   
-  /* Process user input */
-  process_input(client);
+  set_fastopen_connect(client->sfd);
+  open_connection(client);
 }
 
 /*
  * process_input - used to receive user input
- * from stdin. Terminates received string, calls
+ * from stdin. Line is not limited by BUFFER_SIZE.
+ * Terminates received string, calls
  * send_message and waits for server response.
  * @client - pointer to an object of client struct
  */
 void process_input(struct client* client) {
-  char buffer[BUFFER_SIZE];
+  char* buffer = NULL;
+  size_t buffer_size = 0;
+  ssize_t line_len;
   
   /* Wait for user input */
   while (1) {
     printf("Enter message: ");
     
-    /* Read user input */
-    if (fgets(buffer, sizeof(buffer), stdin) == NULL)
-      print_error("fgets");
-    buffer[strlen(buffer) - 1] = '\0';
+    /* Read user input of any length */
+    line_len = getline(&buffer, &buffer_size, stdin);
+    if (line_len == -1) {
+      free(buffer);
+      print_error("getline");
+    }
+    if (line_len > 0 && buffer[line_len - 1] == '\n')
+      buffer[line_len - 1] = '\0';
 
     /* Send user message */
-    send_message(client, client->sfd, buffer);
+    if (send_message(client, client->sfd, buffer) == -1)
+      continue;
 
     /* Receive answer */
     char* message = recv_message(client, client->sfd);
+    
+    /* Request expired, server does not answer it */
+    if (message == NULL && client->timed_out) {
+      printf("CLIENT: No response within %u ms, request expired\n", client->deadline_ms);
+      reconnect_client(client);
+      continue;
+    }
     if (message == NULL) {
       close_connection(client);
       break;
@@ -78,53 +133,82 @@ void process_input(struct client* client) {
     printf("SERVER: Server %s:%d send response: %s\n", client->serv_endpoint->ip, client->serv_endpoint->port, message);
     free(message);
   }
+
+  free(buffer);
 }
 
 /*
  * send_message - used to send message to server. Sends
- * buffer length first, converted to Big Endian, then sends
- * message itself.
+ * frame header (buffer length and QoS class in high byte,
+ * then deadline if it is set), converted to Big Endian, and
+ * message itself
+ * in one call, so whole frame fits in SYN with Fast Open.
+ * Length field has 24 bits, longer message is not sent.
  * @client - pointer to an object of client struct
  * @buffer - string that needs to be sent
+ *
+ * Return: 0 if successful, -1 if message is too long
  */
-void send_message(struct client* client, int fd, const char* buffer) {
-  uint32_t buffer_len = strlen(buffer);
-  uint32_t net_len = htonl(buffer_len);
+int send_message(struct client* client, int fd, const char* buffer) {
+  size_t length = strlen(buffer);
+  uint32_t buffer_len = length;
+  uint32_t flags = client->qos | (client->deadline_ms ? FRAME_DEADLINE : 0);
+  uint32_t net_header[2] = {
+    htonl(buffer_len | (flags << FRAME_CLASS_SHIFT)),
+    htonl(client->deadline_ms),
+  };
+  struct iovec iov[2] = {
+    { .iov_base = net_header, .iov_len = client->deadline_ms ? sizeof(net_header) : sizeof(net_header[0]) },
+    { .iov_base = (void*) buffer, .iov_len = buffer_len },
+  };
+  struct msghdr msg = { .msg_iov = iov, .msg_iovlen = 2 };
   
-  /* Send message length */
-  if (send(fd, &net_len, sizeof(net_len), 0) == -1)
-    print_error("send");
+  /* Length would overwrite QoS and deadline bits */
+  if (length > FRAME_LENGTH_MASK) {
+    printf("CLIENT: Message of %zu bytes is too long, max %d bytes\n", 
+           length, FRAME_LENGTH_MASK);
+    return -1;
+  }
+
+  /* Send message length and message */
+  if (sendmsg(fd, &msg, 0) == -1)
+    print_error("sendmsg");
   
   /* Log message len */
   printf("CLIENT: Send message len: %d\n", buffer_len);
   
-  /* Send message */
-  if (send(fd, buffer, buffer_len, 0) == -1)
-    print_error("send");
-  
   /* Log message*/
   printf("CLIENT: Send message: %s\n", buffer);
+
+  return 0;
 }
 
 /*
  * recv_message - used to receive message from server.
  * Receives message length first, converts to Little Endian,
  * allocates memory for message, then receives it all. Allocated
- * buffer must be freed manually.
+ * buffer must be freed manually. With deadline, sets timed_out
+ * if reply did not arrive in time.
  *
- * Return: string (message) if successful, NULL if connection terminated
+ * Return: string (message) if successful, NULL if connection
+ * terminated or deadline passed
  */
 char* recv_message(struct client* client, int fd) {
   uint32_t net_len;
   uint32_t message_len;
   ssize_t bytes_read;
-  ssize_t total_received;
+  ssize_t total_received = 0;
   char* message;
   
   /* Receive message length */
   bytes_read = recv(fd, &net_len, sizeof(net_len), 0);
+  /* Deadline passed */
+  if (bytes_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+    client->timed_out = 1;
+    return NULL;
+  }
   /* Error occured*/
-  if (bytes_read < 0) {
+  else if (bytes_read < 0) {
     print_error("recv");
   } 
   /* Connection closed */
@@ -145,7 +229,12 @@ char* recv_message(struct client* client, int fd) {
   /* Read all message */
   while (total_received < message_len) {
     bytes_read = recv(fd, message + total_received, message_len - total_received, 0);
-    if (bytes_read < 0) {
+    if (bytes_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      client->timed_out = 1;
+      free(message);
+      return NULL;
+    }
+    else if (bytes_read < 0) {
       free(message);
       print_error("recv");
     }
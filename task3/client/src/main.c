@@ -4,8 +4,12 @@ struct client* client;
 
 void cleanup();
 
-int main(void) {
-  client = create_client(SERVER_IP, SERVER_PORT);
+int main(int argc, char* argv[]) {
+  /* QoS class and deadline in ms may be passed as arguments */
+  uint32_t qos = (argc > 1) ? atoi(argv[1]) : QOS_NORMAL;
+  uint32_t deadline_ms = (argc > 2) ? atoi(argv[2]) : 0;
+  
+  client = create_client(SERVER_IP, SERVER_PORT, qos, deadline_ms);
   atexit(cleanup);
   run_client(client);
   exit(EXIT_SUCCESS);
@@ -0,0 +1,121 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "common.h"
+#include <stdatomic.h>
+
+/**
+ * Used as cached response. Entry is found by hash of
+ * request and full compare of request, so collisions
+ * never return wrong response.
+ */
+struct cache_entry {
+  /* Hash of request */
+  uint64_t hash;
+
+  /* Request */
+  char* key;
+
+  /* Response */
+  char* value;
+
+  /* Next entry in bucket */
+  struct cache_entry* next;
+
+  /* Length of request */
+  uint32_t key_len;
+
+  /* Length of response */
+  uint32_t value_len;
+
+  /* Entry was used since last pass of clock hand */
+  int referenced;
+};
+
+/**
+ * Used as shard of response cache with own lock. Entries
+ * are found through hash buckets and evicted by CLOCK:
+ * hand passes over slots, gives second chance to
+ * referenced entries and evicts first unreferenced one.
+ */
+struct cache_shard {
+  /* Mutex for shard */
+  pthread_mutex_t mutex;
+
+  /* Hash buckets, CACHE_SHARD_SLOTS long */
+  struct cache_entry** buckets;
+
+  /* Slots of clock, CACHE_SHARD_SLOTS long */
+  struct cache_entry** slots;
+
+  /* Position of clock hand */
+  size_t hand;
+
+  /* Memory used by entries */
+  size_t bytes;
+
+  /* Amount of entries */
+  size_t amount;
+
+  /* Amount of lookups that found response */
+  uint64_t hits;
+
+  /* Amount of lookups that did not find response */
+  uint64_t misses;
+
+  /* Amount of evicted entries */
+  uint64_t evictions;
+};
+
+/**
+ * Used as sharded concurrent cache of responses with
+ * memory budget split between shards.
+ */
+struct response_cache {
+  /* Shards, shard is chosen by hash */
+  struct cache_shard shards[CACHE_SHARDS];
+
+  /* Memory budget of shard */
+  size_t shard_budget;
+
+  /* Amount of lookups, used to log statistics */
+  _Atomic uint64_t lookups;
+};
+
+/**
+ * Used as summary of cache statistics.
+ */
+struct cache_stats {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+  size_t amount;
+  size_t bytes;
+};
+
+struct response_cache* create_cache(size_t budget);
+
+uint64_t hash_request(const char* key, size_t key_len);
+
+struct cache_entry* find_entry(struct cache_shard* shard, uint64_t hash, 
+                               const char* key, size_t key_len);
+
+char* cache_lookup(struct response_cache* cache, const char* key, size_t key_len);
+
+ssize_t cache_lookup_into(struct response_cache* cache, const char* key, size_t key_len,
+                          char* buffer, size_t size);
+
+void cache_store(struct response_cache* cache, const char* key, size_t key_len,
+                 const char* value, size_t value_len);
+
+void evict_entry(struct cache_shard* shard);
+
+char* cached_reply(struct response_cache* cache, char* message, char* (*handler)(char*));
+
+void get_cache_stats(struct response_cache* cache, struct cache_stats* stats);
+
+void print_cache_stats(struct response_cache* cache);
+
+void free_cache(struct response_cache* cache);
+
+#endif // !CACHE_H
@@ -0,0 +1,9 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include "common.h"
+#include <time.h>
+
+uint64_t monotonic_ns(void);
+
+#endif // !CLOCK_H
@@ -0,0 +1,33 @@
+#ifndef CODEL_H
+#define CODEL_H
+
+#include "common.h"
+
+/**
+ * Used as CoDel state of one consumer. Requests are
+ * dropped when time in queue stays above CODEL_TARGET_US
+ * for CODEL_INTERVAL_US, drops get more frequent while
+ * standing delay lasts (interval / sqrt(count)).
+ */
+struct codel {
+  /* Time when delay will have been above target for interval, 0 if below */
+  uint64_t first_above;
+
+  /* Time of next drop in dropping state */
+  uint64_t drop_next;
+
+  /* Drops in current dropping state */
+  uint32_t count;
+
+  /* Drops in previous dropping state */
+  uint32_t last_count;
+
+  /* Consumer is in dropping state */
+  int dropping;
+};
+
+void init_codel(struct codel* codel);
+
+int codel_should_drop(struct codel* codel, uint64_t sojourn_ns, uint64_t now);
+
+#endif // !CODEL_H
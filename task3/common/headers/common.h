@@ -1,11 +1,12 @@
 #ifndef COMMON_H
 #define COMMON_H
 
+#define _GNU_SOURCE
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <sys/types.h>
 #include <sys/socket.h>
-#include <sys/msg.h>
 #include <errno.h>
 #include <mqueue.h>
 #include <pthread.h>
@@ -16,11 +17,56 @@
 #include <string.h>
 
 #define CLIENTS_AMOUNT 5
+#define MAX_CLIENTS 1024
+#define MAX_EVENTS 64
 #define BUFFER_SIZE 128
 #define SERVER_IP "127.0.0.1" 
 #define SERVER_PORT 7777
 #define SERVICES_AMOUNT 5
-#define MSQ_FILE "./server"  
+#define MIN_SERVICES 2
+#define MAX_SERVICES 16
+#define WAIT_BUCKETS 32
+#define WAIT_TARGET_US 2000
+#define LOW_UTILIZATION 30
+#define CONTROL_INTERVAL_MS 250
+#define GROW_PERIODS 2
+#define SHRINK_PERIODS 20
+#define QUEUE_SIZE 1024
+#define MAX_BATCH 32
+#define MAX_MESSAGE_SIZE (1 << 20)
+#define MAX_OUTPUT_SIZE (4 * MAX_MESSAGE_SIZE)
+#define FRAME_LENGTH_MASK 0x00FFFFFF
+#define FRAME_CLASS_SHIFT 24
+#define FRAME_CLASS_MASK 0x0F
+#define FRAME_DEADLINE 0x80
+#define CODEL_TARGET_US 5000
+#define CODEL_INTERVAL_US 100000
+#define OVERLOADED_REPLY "Server overloaded"
+#define QOS_NORMAL 0
+#define QOS_CONTROL 1
+#define QOS_BULK 2
+#define QOS_CLASSES 3
+#define QOS_NORMAL_WEIGHT 4
+#define QOS_BULK_WEIGHT 1
+#ifndef FASTOPEN
+#define FASTOPEN 0
+#endif
+#define FASTOPEN_QUEUE 16
+#ifndef RESPONSE_CACHE
+#define RESPONSE_CACHE 0
+#endif
+#ifndef CACHE_BUDGET
+#define CACHE_BUDGET (16 * 1024 * 1024)
+#endif
+#define CACHE_SHARDS 16
+#define CACHE_SHARD_SLOTS 4096
+#define CACHE_STATS_PERIOD 10000
+#ifndef PROCESS_SERVICES
+#define PROCESS_SERVICES 0
+#endif
+#define SHM_RING_SIZE 256
+#define SHM_SLOT_SIZE (64 * 1024)
+#define SHM_MESSAGE_SIZE (SHM_SLOT_SIZE - 128)
 #define print_error(msg) do {perror(msg); \
   exit(EXIT_FAILURE);} while(0)
 
@@ -0,0 +1,54 @@
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+#include "common.h"
+#include "queue.h"
+#include "futex.h"
+
+/**
+ * Used as dispatch position of one consumer. Weighted
+ * lanes are served round robin, lane gives up its turn
+ * after weight requests or when it is empty.
+ */
+struct dispatch_state {
+  /* Lane that has turn */
+  int lane;
+
+  /* Requests lane may still give in its turn */
+  uint32_t credit;
+};
+
+/**
+ * Used as queue of requests of one worker with priority
+ * lanes, one lock-free ring per QoS class. Control lane
+ * is served strictly first, other lanes are served by
+ * weights. Rings are MPMC, so other workers may steal
+ * from them. Owner that finds nothing to do sleeps on
+ * futex word, that is bumped on every enqueue.
+ */
+struct dispatch_queue {
+  /* Ring of requests for every class */
+  struct request_queue* lanes[QOS_CLASSES];
+
+  /* Weight of every lane, 0 for control lane */
+  uint32_t weights[QOS_CLASSES];
+
+  /* Futex word, changed on every enqueue */
+  _Alignas(CACHE_LINE) _Atomic uint32_t futex;
+
+  /* Amount of consumers sleeping on futex */
+  _Atomic uint32_t sleepers;
+};
+
+struct dispatch_queue* create_dispatch_queue(size_t capacity);
+
+int dispatch_request(struct dispatch_queue* queue, const struct user_request* request, int qos);
+
+int try_take_request(struct dispatch_queue* queue, struct dispatch_state* state, 
+                     struct user_request* request);
+
+size_t dispatch_depth(struct dispatch_queue* queue);
+
+void free_dispatch_queue(struct dispatch_queue* queue);
+
+#endif // !DISPATCH_H
@@ -0,0 +1,15 @@
+#ifndef FUTEX_H
+#define FUTEX_H
+
+#include "common.h"
+#include <stdatomic.h>
+
+void futex_wait(_Atomic uint32_t* word, uint32_t value);
+
+void futex_wake(_Atomic uint32_t* word, int amount);
+
+void shared_futex_wait(_Atomic uint32_t* word, uint32_t value);
+
+void shared_futex_wake(_Atomic uint32_t* word, int amount);
+
+#endif // !FUTEX_H
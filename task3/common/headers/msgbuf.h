@@ -2,16 +2,37 @@
 #define MSGBUF_H
 
 #include "common.h"
-#include "../../server/headers/client.h"
+#include "endpoint.h"
+#include "payload.h"
 
+/**
+ * Used as request descriptor passed from listener
+ * server to services through request queue. Message
+ * itself stays in refcounted payload buffer, request
+ * owns one reference to it. Connection is referred by
+ * handle, so reply to closed connection is dropped.
+ */
 struct user_request {
-  struct client client;
-  char message[BUFFER_SIZE];
-};
+  /* Buffer with message */
+  struct payload* payload;
+
+  /* Handle of connection that sent request */
+  uint64_t handle;
+
+  /* Sequence number of request in connection */
+  uint64_t seq;
+
+  /* Time of enqueue (monotonic, ns) */
+  uint64_t timestamp;
+
+  /* Time after which client does not wait for reply, 0 if none */
+  uint64_t deadline;
+
+  /* Offset of message in payload */
+  uint32_t offset;
 
-struct msg {
-  long mtype;
-  struct user_request payload;
+  /* Length of message */
+  uint32_t length;
 };
 
 #endif // !MSGBUF_H
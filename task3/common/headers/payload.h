@@ -0,0 +1,68 @@
+#ifndef PAYLOAD_H
+#define PAYLOAD_H
+
+#include "common.h"
+#include <stdatomic.h>
+
+/* Smallest size class is 2^PAYLOAD_MIN_SHIFT bytes */
+#define PAYLOAD_MIN_SHIFT 6
+
+/* Amount of size classes (64 B .. 64 KB) */
+#define PAYLOAD_CLASSES 11
+
+/* Maximum amount of free buffers kept in one class */
+#define PAYLOAD_CACHED 256
+
+/**
+ * Used as refcounted buffer with request payload. Buffer
+ * is taken from size class of payload pool and returned
+ * there when last reference is released. Buffers larger
+ * than biggest class are allocated directly.
+ */
+struct payload {
+  /* Amount of references to buffer */
+  _Atomic uint32_t refcount;
+
+  /* Size of data */
+  uint32_t capacity;
+
+  /* Size class index, -1 if allocated directly */
+  int size_class;
+
+  /* Next free buffer in size class */
+  struct payload* next;
+
+  /* Pool buffer belongs to */
+  struct payload_pool* pool;
+
+  char data[];
+};
+
+/**
+ * Used as free list of buffers of one size.
+ */
+struct payload_class {
+  pthread_mutex_t mutex;
+  struct payload* free;
+  int free_amount;
+};
+
+/**
+ * Used as pool of payload buffers split to
+ * power of two size classes.
+ */
+struct payload_pool {
+  struct payload_class classes[PAYLOAD_CLASSES];
+};
+
+struct payload_pool* create_payload_pool(void);
+
+struct payload* alloc_payload(struct payload_pool* pool, uint32_t size);
+
+void hold_payload(struct payload* payload);
+
+void release_payload(struct payload* payload);
+
+void free_payload_pool(struct payload_pool* pool);
+
+#endif // !PAYLOAD_H
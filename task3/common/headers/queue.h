@@ -0,0 +1,49 @@
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#include "common.h"
+#include "msgbuf.h"
+#include <stdatomic.h>
+
+#define CACHE_LINE 64
+
+/**
+ * Used as cell of request queue. Sequence tells
+ * producers and consumers whose turn it is to use
+ * the cell (Vyukov bounded MPMC queue).
+ */
+struct queue_cell {
+  _Atomic size_t sequence;
+  struct user_request request;
+};
+
+/**
+ * Bounded lock-free multi-producer multi-consumer
+ * queue of requests. Queue never blocks, waiting for
+ * requests is done by dispatch queue that owns it.
+ */
+struct request_queue {
+  /* Ring of cells, capacity is power of two */
+  struct queue_cell* cells;
+
+  /* Capacity - 1 */
+  size_t mask;
+
+  /* Position of next enqueue */
+  _Alignas(CACHE_LINE) _Atomic size_t enqueue_pos;
+
+  /* Position of next dequeue */
+  _Alignas(CACHE_LINE) _Atomic size_t dequeue_pos;
+};
+
+struct request_queue* create_queue(size_t capacity);
+
+int enqueue_request(struct request_queue* queue, const struct user_request* request);
+
+int try_dequeue_request(struct request_queue* queue, struct user_request* request);
+
+size_t queue_depth(struct request_queue* queue);
+
+void free_queue(struct request_queue* queue);
+
+#endif // !QUEUE_H
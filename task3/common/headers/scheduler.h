@@ -0,0 +1,57 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "common.h"
+#include "dispatch.h"
+
+/**
+ * Used as work-stealing scheduler of requests. Every
+ * worker owns dispatch queue fed by listener server,
+ * connection always goes to the same worker, so its
+ * data stays in cache of one core. Worker that has no
+ * own requests steals from queues of other workers
+ * before going to sleep. Queues exist for maximum amount
+ * of workers, only first active ones get new requests.
+ * Retired worker leaves when its queue is empty, rest of
+ * requests in it is stolen by active workers.
+ */
+struct scheduler {
+  /* Queue of every worker */
+  struct dispatch_queue** queues;
+
+  /* Dispatch position of every worker in its own queue */
+  struct dispatch_state* states;
+
+  /* Maximum amount of workers */
+  int workers;
+
+  /* Amount of active workers */
+  _Atomic int active;
+
+  /* Amount of sleeping workers */
+  _Alignas(CACHE_LINE) _Atomic uint32_t idle;
+};
+
+struct scheduler* create_scheduler(int workers, int active, size_t capacity);
+
+int schedule_request(struct scheduler* scheduler, int worker, 
+                     const struct user_request* request, int qos);
+
+void wake_idle_worker(struct scheduler* scheduler);
+
+void wake_worker(struct scheduler* scheduler, int worker);
+
+size_t take_work(struct scheduler* scheduler, int worker, 
+                 struct user_request* requests, size_t max);
+
+size_t take_own(struct scheduler* scheduler, int worker, 
+                struct user_request* requests, size_t max);
+
+size_t steal_work(struct scheduler* scheduler, int worker, 
+                  struct user_request* requests, size_t max);
+
+size_t scheduler_depth(struct scheduler* scheduler);
+
+void free_scheduler(struct scheduler* scheduler);
+
+#endif // !SCHEDULER_H
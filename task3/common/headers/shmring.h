@@ -0,0 +1,84 @@
+#ifndef SHMRING_H
+#define SHMRING_H
+
+#include "common.h"
+#include "futex.h"
+#include "queue.h"
+
+/**
+ * Used as slot of ring in shared memory. Slot holds
+ * descriptor of request or reply and its message, so
+ * processes pass messages without pointers.
+ */
+struct shm_slot {
+  /* Whose turn it is to use the slot (Vyukov) */
+  _Atomic size_t sequence;
+
+  /* Handle of connection */
+  uint64_t handle;
+
+  /* Sequence number of request in connection */
+  uint64_t seq;
+
+  /* Time of enqueue (monotonic, ns) */
+  uint64_t timestamp;
+
+  /* Time after which client does not wait for reply, 0 if none */
+  uint64_t deadline;
+
+  /* Length of message */
+  uint32_t length;
+
+  /* Request was dropped, reply only takes its turn */
+  uint32_t dropped;
+
+  /* Message */
+  _Alignas(16) char data[];
+};
+
+/**
+ * Used as bounded lock-free MPMC ring placed in shared
+ * memory, slots of fixed size follow the header. Consumers
+ * that find ring empty sleep on shared futex word, that
+ * is bumped on every publish.
+ */
+struct shm_ring {
+  /* Capacity - 1 */
+  size_t mask;
+
+  /* Size of slot with header */
+  size_t slot_size;
+
+  /* Position of next reserve */
+  _Alignas(CACHE_LINE) _Atomic size_t enqueue_pos;
+
+  /* Position of next take */
+  _Alignas(CACHE_LINE) _Atomic size_t dequeue_pos;
+
+  /* Futex word, changed on every publish */
+  _Alignas(CACHE_LINE) _Atomic uint32_t futex;
+
+  /* Amount of consumers sleeping on futex */
+  _Atomic uint32_t sleepers;
+
+  /* Slots */
+  _Alignas(CACHE_LINE) char slots[];
+};
+
+size_t shm_ring_bytes(size_t capacity, size_t slot_size);
+
+void init_shm_ring(struct shm_ring* ring, size_t capacity, size_t slot_size);
+
+size_t shm_slot_capacity(struct shm_ring* ring);
+
+struct shm_slot* reserve_slot(struct shm_ring* ring);
+
+void publish_slot(struct shm_ring* ring, struct shm_slot* slot);
+
+struct shm_slot* try_take_slot(struct shm_ring* ring);
+
+struct shm_slot* take_slot(struct shm_ring* ring);
+
+void release_slot(struct shm_ring* ring, struct shm_slot* slot);
+
+#endif // !SHMRING_H
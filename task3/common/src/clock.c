@@ -0,0 +1,14 @@
+#include "../headers/clock.h"
+
+/*
+ * monotonic_ns - used to get current time of monotonic
+ * clock, used for request timestamps.
+ *
+ * Return: time in nanoseconds
+ */
+uint64_t monotonic_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
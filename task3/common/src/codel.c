@@ -0,0 +1,101 @@
+#include "../headers/codel.h"
+
+/*
+ * isqrt - used to get integer square root.
+ * @value - number
+ *
+ * Return: floor of square root
+ */
+static uint32_t isqrt(uint32_t value) {
+  uint32_t root = 0, bit = 1u << 30;
+
+  while (bit > value)
+    bit >>= 2;
+
+  while (bit) {
+    if (value >= root + bit) {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    }
+    else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+
+  return root;
+}
+
+/*
+ * control_law - used to get time of next drop.
+ * @time - time of current drop (ns)
+ * @count - amount of drops in dropping state
+ *
+ * Return: time of next drop (ns)
+ */
+static uint64_t control_law(uint64_t time, uint32_t count) {
+  return time + CODEL_INTERVAL_US * 1000ULL / isqrt(count ? count : 1);
+}
+
+/*
+ * init_codel - used to initialize CoDel state.
+ * @codel - pointer to an object of codel struct
+ */
+void init_codel(struct codel* codel) {
+  memset(codel, 0, sizeof(*codel));
+}
+
+/*
+ * codel_should_drop - used to decide whether dequeued
+ * request should be dropped because of standing delay.
+ * @codel - pointer to an object of codel struct
+ * @sojourn_ns - time request spent in queue (ns)
+ * @now - current time (monotonic, ns)
+ *
+ * Return: 1 if request should be dropped, 0 otherwise
+ */
+int codel_should_drop(struct codel* codel, uint64_t sojourn_ns, uint64_t now) {
+  int ok_to_drop = 0;
+  
+  /* Delay should stay above target for whole interval */
+  if (sojourn_ns < CODEL_TARGET_US * 1000ULL)
+    codel->first_above = 0;
+  else if (codel->first_above == 0)
+    codel->first_above = now + CODEL_INTERVAL_US * 1000ULL;
+  else if (now >= codel->first_above)
+    ok_to_drop = 1;
+
+  if (codel->dropping) {
+    /* Delay went below target, leave dropping state */
+    if (!ok_to_drop) {
+      codel->dropping = 0;
+      return 0;
+    }
+    
+    /* Drop more often while delay stays */
+    if (now >= codel->drop_next) {
+      codel->count++;
+      codel->drop_next = control_law(codel->drop_next, codel->count);
+      return 1;
+    }
+
+    return 0;
+  }
+  
+  if (ok_to_drop) {
+    uint32_t delta = codel->count - codel->last_count;
+    
+    /* Start from previous rate if dropping state was left recently */
+    codel->dropping = 1;
+    if (delta > 1 && now - codel->drop_next < 16 * CODEL_INTERVAL_US * 1000ULL)
+      codel->count = delta;
+    else
+      codel->count = 1;
+    
+    codel->drop_next = control_law(now, codel->count);
+    codel->last_count = codel->count;
+    return 1;
+  }
+
+  return 0;
+}
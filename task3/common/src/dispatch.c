@@ -0,0 +1,118 @@
+#include "../headers/dispatch.h"
+
+/*
+ * create_dispatch_queue - used to create an object of
+ * dispatch_queue struct with ring for every QoS class.
+ * @capacity - capacity of every lane, power of two
+ *
+ * Return: pointer to an object of dispatch_queue struct
+ */
+struct dispatch_queue* create_dispatch_queue(size_t capacity) {
+  struct dispatch_queue* queue;
+
+  queue = (struct dispatch_queue*) aligned_alloc(CACHE_LINE, sizeof(struct dispatch_queue));
+  if (!queue)
+    print_error("aligned_alloc");
+  
+  for (int i = 0; i < QOS_CLASSES; i++)
+    queue->lanes[i] = create_queue(capacity);
+
+  queue->weights[QOS_NORMAL] = QOS_NORMAL_WEIGHT;
+  queue->weights[QOS_CONTROL] = 0;
+  queue->weights[QOS_BULK] = QOS_BULK_WEIGHT;
+
+  atomic_init(&queue->futex, 0);
+  atomic_init(&queue->sleepers, 0);
+
+  return queue;
+}
+
+/*
+ * dispatch_request - used to put request to lane of its
+ * class without blocking. Unknown class goes to normal lane.
+ * Wakes consumer if it sleeps on queue.
+ * @queue - pointer to an object of dispatch_queue struct
+ * @request - request to copy into queue
+ * @qos - QoS class of request
+ *
+ * Return: 0 if successful, -1 if lane is full
+ */
+int dispatch_request(struct dispatch_queue* queue, const struct user_request* request, int qos) {
+  if (qos < 0 || qos >= QOS_CLASSES)
+    qos = QOS_NORMAL;
+
+  if (enqueue_request(queue->lanes[qos], request) == -1)
+    return -1;
+  
+  /* Wake consumer if someone sleeps */
+  atomic_fetch_add(&queue->futex, 1);
+  if (atomic_load(&queue->sleepers) > 0)
+    futex_wake(&queue->futex, 1);
+
+  return 0;
+}
+
+/*
+ * try_take_request - used to take request from queue without
+ * blocking. Control lane is checked first, then weighted lanes
+ * in turn of consumer.
+ * @queue - pointer to an object of dispatch_queue struct
+ * @state - dispatch position of consumer
+ * @request - pointer to store request
+ *
+ * Return: 0 if successful, -1 if all lanes are empty
+ */
+int try_take_request(struct dispatch_queue* queue, struct dispatch_state* state, 
+                     struct user_request* request) {
+  /* Control requests go first */
+  if (try_dequeue_request(queue->lanes[QOS_CONTROL], request) == 0)
+    return 0;
+  
+  /* Every weighted lane gets its turn */
+  for (int i = 0; i < QOS_CLASSES; i++) {
+    /* Pass turn to next weighted lane */
+    if (state->credit == 0) {
+      do
+        state->lane = (state->lane + 1) % QOS_CLASSES;
+      while (queue->weights[state->lane] == 0);
+      state->credit = queue->weights[state->lane];
+    }
+
+    if (try_dequeue_request(queue->lanes[state->lane], request) == 0) {
+      state->credit--;
+      return 0;
+    }
+    
+    /* Empty lane gives up its turn */
+    state->credit = 0;
+  }
+  
+  return -1;
+}
+
+/*
+ * dispatch_depth - used to get approximate amount of
+ * requests in all lanes.
+ * @queue - pointer to an object of dispatch_queue struct
+ *
+ * Return: amount of requests
+ */
+size_t dispatch_depth(struct dispatch_queue* queue) {
+  size_t depth = 0;
+
+  for (int i = 0; i < QOS_CLASSES; i++)
+    depth += queue_depth(queue->lanes[i]);
+
+  return depth;
+}
+
+/*
+ * free_dispatch_queue - used to free allocated memory
+ * for dispatch_queue struct and its lanes.
+ * @queue - pointer to an object of dispatch_queue struct
+ */
+void free_dispatch_queue(struct dispatch_queue* queue) {
+  for (int i = 0; i < QOS_CLASSES; i++)
+    free_queue(queue->lanes[i]);
+  free(queue);
+}
@@ -0,0 +1,41 @@
+#include "../headers/futex.h"
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+/*
+ * futex_wait - used to sleep while futex word equals value.
+ * @word - pointer to futex word
+ * @value - expected value of futex word
+ */
+void futex_wait(_Atomic uint32_t* word, uint32_t value) {
+  syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+}
+
+/*
+ * futex_wake - used to wake threads sleeping on futex word.
+ * @word - pointer to futex word
+ * @amount - amount of threads to wake
+ */
+void futex_wake(_Atomic uint32_t* word, int amount) {
+  syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, amount, NULL, NULL, 0);
+}
+
+/*
+ * shared_futex_wait - used to sleep while futex word in
+ * memory shared between processes equals value.
+ * @word - pointer to futex word
+ * @value - expected value of futex word
+ */
+void shared_futex_wait(_Atomic uint32_t* word, uint32_t value) {
+  syscall(SYS_futex, word, FUTEX_WAIT, value, NULL, NULL, 0);
+}
+
+/*
+ * shared_futex_wake - used to wake threads of any process
+ * sleeping on futex word in shared memory.
+ * @word - pointer to futex word
+ * @amount - amount of threads to wake
+ */
+void shared_futex_wake(_Atomic uint32_t* word, int amount) {
+  syscall(SYS_futex, word, FUTEX_WAKE, amount, NULL, NULL, 0);
+}
@@ -0,0 +1,142 @@
+#include "../headers/payload.h"
+
+/*
+ * size_to_class - used to find smallest size class
+ * that fits size.
+ * @size - required size of data
+ *
+ * Return: index of size class, -1 if size is too big
+ */
+static int size_to_class(uint32_t size) {
+  for (int i = 0; i < PAYLOAD_CLASSES; i++) {
+    if (size <= (1u << (PAYLOAD_MIN_SHIFT + i)))
+      return i;
+  }
+
+  return -1;
+}
+
+/*
+ * create_payload_pool - used to create an object of
+ * payload_pool struct with empty size classes.
+ *
+ * Return: pointer to an object of payload_pool struct
+ */
+struct payload_pool* create_payload_pool(void) {
+  struct payload_pool* pool = (struct payload_pool*) malloc(sizeof(struct payload_pool));
+  if (!pool)
+    print_error("malloc");
+
+  for (int i = 0; i < PAYLOAD_CLASSES; i++) {
+    if (pthread_mutex_init(&pool->classes[i].mutex, NULL) != 0)
+      print_error("pthread_mutex_init");
+    pool->classes[i].free = NULL;
+    pool->classes[i].free_amount = 0;
+  }
+
+  return pool;
+}
+
+/*
+ * alloc_payload - used to get buffer for payload of size
+ * bytes. Buffer has one reference owned by caller.
+ * @pool - pointer to an object of payload_pool struct
+ * @size - required size of data
+ *
+ * Return: pointer to an object of payload struct
+ */
+struct payload* alloc_payload(struct payload_pool* pool, uint32_t size) {
+  struct payload* payload = NULL;
+  int size_class = size_to_class(size);
+  
+  /* Reuse free buffer of class */
+  if (size_class != -1) {
+    struct payload_class* class = &pool->classes[size_class];
+    
+    pthread_mutex_lock(&class->mutex);
+    if (class->free) {
+      payload = class->free;
+      class->free = payload->next;
+      class->free_amount--;
+    }
+    pthread_mutex_unlock(&class->mutex);
+  }
+  
+  /* Allocate new buffer */
+  if (!payload) {
+    uint32_t capacity = (size_class != -1) ? (1u << (PAYLOAD_MIN_SHIFT + size_class)) : size;
+    
+    payload = (struct payload*) malloc(sizeof(struct payload) + capacity);
+    if (!payload)
+      print_error("malloc");
+    
+    payload->capacity = capacity;
+    payload->size_class = size_class;
+    payload->pool = pool;
+  }
+
+  payload->next = NULL;
+  atomic_init(&payload->refcount, 1);
+
+  return payload;
+}
+
+/*
+ * hold_payload - used to take one more reference to buffer.
+ * @payload - pointer to an object of payload struct
+ */
+void hold_payload(struct payload* payload) {
+  atomic_fetch_add_explicit(&payload->refcount, 1, memory_order_relaxed);
+}
+
+/*
+ * release_payload - used to drop reference to buffer.
+ * Last reference returns buffer to its size class.
+ * @payload - pointer to an object of payload struct
+ */
+void release_payload(struct payload* payload) {
+  struct payload_class* class;
+
+  if (atomic_fetch_sub_explicit(&payload->refcount, 1, memory_order_acq_rel) != 1)
+    return;
+  
+  /* Oversized buffer */
+  if (payload->size_class == -1) {
+    free(payload);
+    return;
+  }
+  
+  class = &payload->pool->classes[payload->size_class];
+  
+  pthread_mutex_lock(&class->mutex);
+  if (class->free_amount < PAYLOAD_CACHED) {
+    payload->next = class->free;
+    class->free = payload;
+    class->free_amount++;
+    payload = NULL;
+  }
+  pthread_mutex_unlock(&class->mutex);
+  
+  /* Class is full */
+  free(payload);
+}
+
+/*
+ * free_payload_pool - used to free allocated memory for
+ * payload_pool struct and its free buffers.
+ * @pool - pointer to an object of payload_pool struct
+ */
+void free_payload_pool(struct payload_pool* pool) {
+  for (int i = 0; i < PAYLOAD_CLASSES; i++) {
+    struct payload* payload = pool->classes[i].free;
+    
+    while (payload) {
+      struct payload* next = payload->next;
+      free(payload);
+      payload = next;
+    }
+    pthread_mutex_destroy(&pool->classes[i].mutex);
+  }
+
+  free(pool);
+}
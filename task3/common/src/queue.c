@@ -0,0 +1,139 @@
+#include "../headers/queue.h"
+
+/*
+ * create_queue - used to create an object of request_queue
+ * struct. 
+ * @capacity - maximum amount of requests, power of two
+ *
+ * Return: pointer to an object of request_queue struct
+ */
+struct request_queue* create_queue(size_t capacity) {
+  struct request_queue* queue;
+  
+  if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+    fprintf(stderr, "create_queue: capacity must be power of two\n");
+    exit(EXIT_FAILURE);
+  }
+
+  queue = (struct request_queue*) aligned_alloc(CACHE_LINE, sizeof(struct request_queue));
+  if (!queue)
+    print_error("aligned_alloc");
+
+  queue->cells = (struct queue_cell*) malloc(capacity * sizeof(struct queue_cell));
+  if (!queue->cells)
+    print_error("malloc");
+  
+  /* Cell i is free for enqueue number i */
+  for (size_t i = 0; i < capacity; i++)
+    atomic_init(&queue->cells[i].sequence, i);
+
+  queue->mask = capacity - 1;
+  atomic_init(&queue->enqueue_pos, 0);
+  atomic_init(&queue->dequeue_pos, 0);
+
+  return queue;
+}
+
+/*
+ * enqueue_request - used to put request to queue without
+ * blocking.
+ * @queue - pointer to an object of request_queue struct
+ * @request - request to copy into queue
+ *
+ * Return: 0 if successful, -1 if queue is full
+ */
+int enqueue_request(struct request_queue* queue, const struct user_request* request) {
+  struct queue_cell* cell;
+  size_t pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+
+  while (1) {
+    cell = &queue->cells[pos & queue->mask];
+    size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+    intptr_t diff = (intptr_t) sequence - (intptr_t) pos;
+    
+    /* Cell is free, try to take position */
+    if (diff == 0) {
+      if (atomic_compare_exchange_weak_explicit(&queue->enqueue_pos, &pos, pos + 1,
+                                                memory_order_relaxed, memory_order_relaxed))
+        break;
+    }
+    /* Cell is not consumed yet, queue is full */
+    else if (diff < 0) {
+      return -1;
+    }
+    /* Other producer took position */
+    else {
+      pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+    }
+  }
+  
+  /* Publish request */
+  cell->request = *request;
+  atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+
+  return 0;
+}
+
+/*
+ * try_dequeue_request - used to take request from queue
+ * without blocking.
+ * @queue - pointer to an object of request_queue struct
+ * @request - pointer to store request
+ *
+ * Return: 0 if successful, -1 if queue is empty
+ */
+int try_dequeue_request(struct request_queue* queue, struct user_request* request) {
+  struct queue_cell* cell;
+  size_t pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+
+  while (1) {
+    cell = &queue->cells[pos & queue->mask];
+    size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+    intptr_t diff = (intptr_t) sequence - (intptr_t) (pos + 1);
+    
+    /* Cell is published, try to take position */
+    if (diff == 0) {
+      if (atomic_compare_exchange_weak_explicit(&queue->dequeue_pos, &pos, pos + 1,
+                                                memory_order_relaxed, memory_order_relaxed))
+        break;
+    }
+    /* Cell is not published yet, queue is empty */
+    else if (diff < 0) {
+      return -1;
+    }
+    /* Other consumer took position */
+    else {
+      pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+    }
+  }
+
+  /* Take request and free cell for next lap */
+  *request = cell->request;
+  atomic_store_explicit(&cell->sequence, pos + queue->mask + 1, memory_order_release);
+
+  return 0;
+}
+
+/*
+ * queue_depth - used to get approximate amount of
+ * requests in queue.
+ * @queue - pointer to an object of request_queue struct
+ *
+ * Return: amount of requests
+ */
+size_t queue_depth(struct request_queue* queue) {
+  size_t enqueue_pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+  size_t dequeue_pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+
+  return (enqueue_pos > dequeue_pos) ? enqueue_pos - dequeue_pos : 0;
+}
+
+/*
+ * free_queue - used to free allocated memory
+ * for request_queue struct.
+ * @queue - pointer to an object of request_queue struct
+ */
+void free_queue(struct request_queue* queue) {
+  free(queue->cells);
+  free(queue);
+}
@@ -0,0 +1,215 @@
+#include "../headers/scheduler.h"
+
+/*
+ * create_scheduler - used to create an object of scheduler
+ * struct with dispatch queue for every worker.
+ * @workers - maximum amount of workers
+ * @active - amount of active workers
+ * @capacity - capacity of every lane, power of two
+ *
+ * Return: pointer to an object of scheduler struct
+ */
+struct scheduler* create_scheduler(int workers, int active, size_t capacity) {
+  struct scheduler* scheduler;
+
+  scheduler = (struct scheduler*) aligned_alloc(CACHE_LINE, sizeof(struct scheduler));
+  if (!scheduler)
+    print_error("aligned_alloc");
+  
+  scheduler->queues = (struct dispatch_queue**) malloc(workers * sizeof(struct dispatch_queue*));
+  scheduler->states = (struct dispatch_state*) calloc(workers, sizeof(struct dispatch_state));
+  if (!scheduler->queues || !scheduler->states)
+    print_error("malloc");
+
+  for (int i = 0; i < workers; i++)
+    scheduler->queues[i] = create_dispatch_queue(capacity);
+
+  scheduler->workers = workers;
+  atomic_init(&scheduler->active, active);
+  atomic_init(&scheduler->idle, 0);
+
+  return scheduler;
+}
+
+/*
+ * schedule_request - used to put request to queue of worker
+ * without blocking. If worker is busy, wakes idle worker
+ * to steal request.
+ * @scheduler - pointer to an object of scheduler struct
+ * @worker - index of worker of connection
+ * @request - request to copy into queue
+ * @qos - QoS class of request
+ *
+ * Return: 0 if successful, -1 if lane is full
+ */
+int schedule_request(struct scheduler* scheduler, int worker, 
+                     const struct user_request* request, int qos) {
+  struct dispatch_queue* queue = scheduler->queues[worker];
+
+  if (dispatch_request(queue, request, qos) == -1)
+    return -1;
+  
+  /* Owner is busy, let idle worker help */
+  if (atomic_load(&queue->sleepers) == 0 && atomic_load(&scheduler->idle) > 0)
+    wake_idle_worker(scheduler);
+
+  return 0;
+}
+
+/*
+ * wake_idle_worker - used to wake one sleeping worker.
+ * @scheduler - pointer to an object of scheduler struct
+ */
+void wake_idle_worker(struct scheduler* scheduler) {
+  for (int i = 0; i < scheduler->workers; i++) {
+    struct dispatch_queue* queue = scheduler->queues[i];
+
+    if (atomic_load(&queue->sleepers) > 0) {
+      wake_worker(scheduler, i);
+      return;
+    }
+  }
+}
+
+/*
+ * wake_worker - used to wake worker if it sleeps.
+ * @scheduler - pointer to an object of scheduler struct
+ * @worker - index of worker
+ */
+void wake_worker(struct scheduler* scheduler, int worker) {
+  struct dispatch_queue* queue = scheduler->queues[worker];
+
+  atomic_fetch_add(&queue->futex, 1);
+  futex_wake(&queue->futex, 1);
+}
+
+/*
+ * take_work - used to take batch of requests for worker.
+ * Own queue goes first, then queues of other workers.
+ * Sleeps on own futex while there is nothing to do.
+ * @scheduler - pointer to an object of scheduler struct
+ * @worker - index of worker
+ * @requests - array to store requests
+ * @max - size of array
+ *
+ * Return: amount of requests taken, 0 if worker is retired
+ */
+size_t take_work(struct scheduler* scheduler, int worker, 
+                 struct user_request* requests, size_t max) {
+  struct dispatch_queue* queue = scheduler->queues[worker];
+  size_t amount;
+
+  while (1) {
+    uint32_t futex = atomic_load(&queue->futex);
+    
+    if ((amount = take_own(scheduler, worker, requests, max)) > 0)
+      return amount;
+    
+    /* Retired worker leaves when own queue is empty */
+    if (worker >= atomic_load(&scheduler->active))
+      return 0;
+    
+    if ((amount = steal_work(scheduler, worker, requests, max)) > 0)
+      return amount;
+    
+    /* Announce sleep, then check again to not miss enqueue */
+    atomic_fetch_add(&queue->sleepers, 1);
+    atomic_fetch_add(&scheduler->idle, 1);
+    
+    if ((amount = take_own(scheduler, worker, requests, max)) == 0 &&
+        (amount = steal_work(scheduler, worker, requests, max)) == 0)
+      futex_wait(&queue->futex, futex);
+
+    atomic_fetch_sub(&scheduler->idle, 1);
+    atomic_fetch_sub(&queue->sleepers, 1);
+    
+    if (amount > 0)
+      return amount;
+  }
+}
+
+/*
+ * take_own - used to take batch of requests from own queue
+ * of worker without blocking. Whole queue belongs to worker,
+ * so batch grows with its depth up to max.
+ * @scheduler - pointer to an object of scheduler struct
+ * @worker - index of worker
+ * @requests - array to store requests
+ * @max - size of array
+ *
+ * Return: amount of requests taken
+ */
+size_t take_own(struct scheduler* scheduler, int worker, 
+                struct user_request* requests, size_t max) {
+  struct dispatch_queue* queue = scheduler->queues[worker];
+  struct dispatch_state* state = &scheduler->states[worker];
+  size_t amount = 0;
+
+  while (amount < max && try_take_request(queue, state, &requests[amount]) == 0)
+    amount++;
+
+  return amount;
+}
+
+/*
+ * steal_work - used to take requests from queues of other
+ * workers without blocking. Victims are visited starting
+ * from next worker, so thieves spread over queues. Thief
+ * takes half of victims queue, owner keeps the rest.
+ * @scheduler - pointer to an object of scheduler struct
+ * @worker - index of thief
+ * @requests - array to store requests
+ * @max - size of array
+ *
+ * Return: amount of requests taken
+ */
+size_t steal_work(struct scheduler* scheduler, int worker, 
+                  struct user_request* requests, size_t max) {
+  struct dispatch_state state = { .lane = QOS_NORMAL, .credit = 0 };
+  
+  for (int i = 1; i < scheduler->workers; i++) {
+    struct dispatch_queue* victim = scheduler->queues[(worker + i) % scheduler->workers];
+    size_t batch = dispatch_depth(victim) / 2 + 1;
+    size_t amount = 0;
+    
+    if (batch > max)
+      batch = max;
+
+    while (amount < batch && try_take_request(victim, &state, &requests[amount]) == 0)
+      amount++;
+
+    if (amount > 0)
+      return amount;
+  }
+
+  return 0;
+}
+
+/*
+ * scheduler_depth - used to get approximate amount of
+ * requests in all queues.
+ * @scheduler - pointer to an object of scheduler struct
+ *
+ * Return: amount of requests
+ */
+size_t scheduler_depth(struct scheduler* scheduler) {
+  size_t depth = 0;
+
+  for (int i = 0; i < scheduler->workers; i++)
+    depth += dispatch_depth(scheduler->queues[i]);
+
+  return depth;
+}
+
+/*
+ * free_scheduler - used to free allocated memory
+ * for scheduler struct and queues of workers.
+ * @scheduler - pointer to an object of scheduler struct
+ */
+void free_scheduler(struct scheduler* scheduler) {
+  for (int i = 0; i < scheduler->workers; i++)
+    free_dispatch_queue(scheduler->queues[i]);
+  free(scheduler->queues);
+  free(scheduler->states);
+  free(scheduler);
+}
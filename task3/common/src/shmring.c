@@ -0,0 +1,180 @@
+#include "../headers/shmring.h"
+
+/*
+ * ring_slot - used to get slot by position.
+ * @ring - pointer to an object of shm_ring struct
+ * @pos - position in ring
+ *
+ * Return: pointer to slot
+ */
+static struct shm_slot* ring_slot(struct shm_ring* ring, size_t pos) {
+  return (struct shm_slot*) (ring->slots + (pos & ring->mask) * ring->slot_size);
+}
+
+/*
+ * shm_ring_bytes - used to get size of memory for ring.
+ * @capacity - amount of slots, power of two
+ * @slot_size - size of slot with header, multiple of CACHE_LINE
+ *
+ * Return: size in bytes
+ */
+size_t shm_ring_bytes(size_t capacity, size_t slot_size) {
+  return sizeof(struct shm_ring) + capacity * slot_size;
+}
+
+/*
+ * init_shm_ring - used to initialize ring in memory of
+ * shm_ring_bytes size, that is shared between processes.
+ * @ring - pointer to memory for ring
+ * @capacity - amount of slots, power of two
+ * @slot_size - size of slot with header, multiple of CACHE_LINE
+ */
+void init_shm_ring(struct shm_ring* ring, size_t capacity, size_t slot_size) {
+  if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+    fprintf(stderr, "init_shm_ring: capacity must be power of two\n");
+    exit(EXIT_FAILURE);
+  }
+
+  ring->mask = capacity - 1;
+  ring->slot_size = slot_size;
+  atomic_init(&ring->enqueue_pos, 0);
+  atomic_init(&ring->dequeue_pos, 0);
+  atomic_init(&ring->futex, 0);
+  atomic_init(&ring->sleepers, 0);
+  
+  /* Slot i is free for reserve number i */
+  for (size_t i = 0; i < capacity; i++)
+    atomic_init(&ring_slot(ring, i)->sequence, i);
+}
+
+/*
+ * shm_slot_capacity - used to get maximum length of
+ * message in slot.
+ * @ring - pointer to an object of shm_ring struct
+ *
+ * Return: size in bytes
+ */
+size_t shm_slot_capacity(struct shm_ring* ring) {
+  return ring->slot_size - sizeof(struct shm_slot);
+}
+
+/*
+ * reserve_slot - used to take free slot for filling
+ * without blocking. Slot should be published after.
+ * @ring - pointer to an object of shm_ring struct
+ *
+ * Return: pointer to slot, NULL if ring is full
+ */
+struct shm_slot* reserve_slot(struct shm_ring* ring) {
+  struct shm_slot* slot;
+  size_t pos = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+
+  while (1) {
+    slot = ring_slot(ring, pos);
+    size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+    intptr_t diff = (intptr_t) sequence - (intptr_t) pos;
+    
+    /* Slot is free, try to take position */
+    if (diff == 0) {
+      if (atomic_compare_exchange_weak_explicit(&ring->enqueue_pos, &pos, pos + 1,
+                                                memory_order_relaxed, memory_order_relaxed))
+        return slot;
+    }
+    /* Slot is not consumed yet, ring is full */
+    else if (diff < 0) {
+      return NULL;
+    }
+    /* Other producer took position */
+    else {
+      pos = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+    }
+  }
+}
+
+/*
+ * publish_slot - used to pass filled slot to consumers.
+ * Wakes one consumer if someone sleeps.
+ * @ring - pointer to an object of shm_ring struct
+ * @slot - slot taken by reserve_slot
+ */
+void publish_slot(struct shm_ring* ring, struct shm_slot* slot) {
+  size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+
+  atomic_store_explicit(&slot->sequence, sequence + 1, memory_order_release);
+  
+  /* Wake consumer if someone sleeps */
+  atomic_fetch_add(&ring->futex, 1);
+  if (atomic_load(&ring->sleepers) > 0)
+    shared_futex_wake(&ring->futex, 1);
+}
+
+/*
+ * try_take_slot - used to take published slot without
+ * blocking. Slot should be released after.
+ * @ring - pointer to an object of shm_ring struct
+ *
+ * Return: pointer to slot, NULL if ring is empty
+ */
+struct shm_slot* try_take_slot(struct shm_ring* ring) {
+  struct shm_slot* slot;
+  size_t pos = atomic_load_explicit(&ring->dequeue_pos, memory_order_relaxed);
+
+  while (1) {
+    slot = ring_slot(ring, pos);
+    size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+    intptr_t diff = (intptr_t) sequence - (intptr_t) (pos + 1);
+    
+    /* Slot is published, try to take position */
+    if (diff == 0) {
+      if (atomic_compare_exchange_weak_explicit(&ring->dequeue_pos, &pos, pos + 1,
+                                                memory_order_relaxed, memory_order_relaxed))
+        return slot;
+    }
+    /* Slot is not published yet, ring is empty */
+    else if (diff < 0) {
+      return NULL;
+    }
+    /* Other consumer took position */
+    else {
+      pos = atomic_load_explicit(&ring->dequeue_pos, memory_order_relaxed);
+    }
+  }
+}
+
+/*
+ * take_slot - used to take published slot. Sleeps on
+ * shared futex while ring is empty.
+ * @ring - pointer to an object of shm_ring struct
+ *
+ * Return: pointer to slot
+ */
+struct shm_slot* take_slot(struct shm_ring* ring) {
+  struct shm_slot* slot;
+
+  while ((slot = try_take_slot(ring)) == NULL) {
+    uint32_t futex = atomic_load(&ring->futex);
+
+    /* Announce sleep, then check again to not miss publish */
+    atomic_fetch_add(&ring->sleepers, 1);
+    if ((slot = try_take_slot(ring)) != NULL) {
+      atomic_fetch_sub(&ring->sleepers, 1);
+      return slot;
+    }
+
+    shared_futex_wait(&ring->futex, futex);
+    atomic_fetch_sub(&ring->sleepers, 1);
+  }
+
+  return slot;
+}
+
+/*
+ * release_slot - used to free taken slot for next lap.
+ * @ring - pointer to an object of shm_ring struct
+ * @slot - slot taken by take_slot or try_take_slot
+ */
+void release_slot(struct shm_ring* ring, struct shm_slot* slot) {
+  size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+
+  atomic_store_explicit(&slot->sequence, sequence + ring->mask, memory_order_release);
+}
@@ -2,24 +2,147 @@
 #define CLIENT_H
 
 #include "../../common/headers/common.h"
+#include "../../common/headers/endpoint.h"
+#include <stdatomic.h>
+#include <sys/uio.h>
+
+/**
+ * Used as reply waiting in reorder buffer of
+ * connection until replies for all previous
+ * requests are sent.
+ */
+struct reply {
+  /* Sequence number of request */
+  uint64_t seq;
+
+  /* Reply message, NULL if request was dropped */
+  char* data;
+
+  /* Length of reply */
+  uint32_t length;
+
+  /* Next reply in reorder buffer */
+  struct reply* next;
+};
 
 /**
  * Used as data struct to specify clients
- * address, descriptor for communication 
+ * address, descriptor for communication,
+ * state of message that is being received and
+ * reorder buffer for replies. Replies that socket
+ * did not accept wait in output buffer until it is
+ * writable. Object lives while listener or thread
+ * sending replies holds reference to it.
  */
 struct client {
   /* Clients address */
-  struct sockaddr_in* addr;
-  
+  struct sockaddr_in addr;
+
   struct server* server;
 
   /* IP and port */
   struct endpoint* endpoint;
 
-  int id;
-  
+  /* Message being received, NULL while length is received */
+  struct payload* payload;
+
+  /* Replies waiting for their turn, sorted by sequence */
+  struct reply* pending;
+
+  /* Mutex for reorder buffer */
+  pthread_mutex_t reply_mutex;
+
+  /* Sequence number of next request (listener only) */
+  uint64_t next_seq;
+
+  /* Sequence number of next reply to send */
+  uint64_t send_seq;
+
+  /* Amount of references to client */
+  _Atomic int refcount;
+
+  /* Some thread is writing replies to socket */
+  int writing;
+
+  /* Socket is broken, replies are dropped */
+  int broken;
+
+  /* Listener writes replies when socket becomes writable */
+  int watching;
+
+  /* Framed replies not accepted by socket yet */
+  char* output;
+
+  /* Bytes in output buffer */
+  size_t output_len;
+
+  /* Bytes of output buffer already sent */
+  size_t output_sent;
+
+  /* Allocated size of output buffer */
+  size_t output_size;
+
+  /* Frame header in network form: length, optional deadline */
+  uint32_t net_header[2];
+
+  /* Size of frame header */
+  uint32_t header_size;
+
+  /* Deadline of message being received, 0 if none */
+  uint64_t deadline;
+
+  /* Length of message being received */
+  uint32_t message_len;
+
+  /* QoS class of message being received */
+  int qos;
+
+  /* Index of worker that serves connection */
+  int worker;
+
+  /* Bytes of frame header received */
+  uint32_t header_received;
+
+  /* Bytes of message received */
+  uint32_t message_received;
+
+  /* Handle of connection in connection table */
+  uint64_t handle;
+
   /* File descriptor for communication */
   int fd;
 };
 
+struct client* create_client(struct sockaddr_in* addr, int fd);
+
+void hold_client(struct client* client);
+
+void release_client(struct client* client);
+
+void submit_replies(struct client* client, struct reply* replies);
+
+void defer_replies(struct client* client, struct reply* replies);
+
+void resume_replies(struct client* client);
+
+void write_ready_replies(struct client* client);
+
+void watch_output(struct client* client, int enable);
+
+void insert_reply(struct client* client, struct reply* reply);
+
+struct reply* take_ready_replies(struct client* client);
+
+int write_replies(struct client* client, struct reply* replies);
+
+ssize_t send_replies(int fd, struct iovec* iov, int iovcnt);
+
+int queue_output(struct client* client, struct iovec* iov, int iovcnt, size_t skip);
+
+int flush_output(struct client* client);
+
+void break_connection(struct client* client);
+
+void free_replies(struct reply* replies);
+
 #endif // !CLIENT_H
@@ -0,0 +1,60 @@
+#ifndef CONNTABLE_H
+#define CONNTABLE_H
+
+#include "../../common/headers/common.h"
+#include "client.h"
+
+/* Handle that never refers to connection */
+#define INVALID_HANDLE 0
+
+/**
+ * Used as slot of connection table. Generation is
+ * changed every time slot is freed, so handles issued
+ * for previous connection in slot become stale.
+ */
+struct conn_slot {
+  /* Client in slot, NULL if slot is free */
+  struct client* client;
+
+  /* Generation of connection in slot */
+  uint32_t generation;
+
+  /* Index of next free slot */
+  int next_free;
+};
+
+/**
+ * Used as table of connections of listener server.
+ * Connections are referred by opaque handles
+ * (generation << 32 | index), so request that outlives
+ * its connection can not reach client that got the same
+ * file descriptor or slot later.
+ */
+struct conn_table {
+  /* Array of slots */
+  struct conn_slot* slots;
+
+  /* Mutex for slots */
+  pthread_mutex_t mutex;
+
+  /* Amount of slots */
+  int capacity;
+
+  /* Amount of used slots */
+  int amount;
+
+  /* Index of first free slot, -1 if table is full */
+  int free_head;
+};
+
+struct conn_table* create_conn_table(int capacity);
+
+uint64_t register_client(struct conn_table* table, struct client* client);
+
+void unregister_client(struct conn_table* table, uint64_t handle);
+
+struct client* resolve_client(struct conn_table* table, uint64_t handle);
+
+void free_conn_table(struct conn_table* table);
+
+#endif // !CONNTABLE_H
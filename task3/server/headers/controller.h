@@ -0,0 +1,61 @@
+#ifndef CONTROLLER_H
+#define CONTROLLER_H
+
+#include "../../common/headers/common.h"
+#include "../../common/headers/clock.h"
+
+struct server;
+
+/**
+ * Used as controller of services pool. Every interval
+ * it collects queue wait and utilization of services.
+ * Pool grows when p99 of queue wait stays above target
+ * while services are busy (more services do not help if
+ * they are idle) and shrinks when utilization stays low,
+ * within MIN_SERVICES and MAX_SERVICES. Streaks of
+ * periods are required for both, so pool does not flap.
+ */
+struct controller {
+  /* Server with pool of services */
+  struct server* server;
+
+  /* Thread of controller */
+  pthread_t thread;
+
+  /* Thread is running */
+  int running;
+
+  /* p99 of queue wait in last interval (us) */
+  uint64_t wait_p99_us;
+
+  /* Utilization of active services in last interval (%) */
+  int utilization;
+
+  /* Intervals in a row with wait above target */
+  int high_periods;
+
+  /* Intervals in a row with low utilization */
+  int low_periods;
+
+  /* Amount of times pool grew */
+  uint64_t grows;
+
+  /* Amount of times pool shrank */
+  uint64_t shrinks;
+};
+
+struct controller* create_controller(struct server* server);
+
+void start_controller(struct controller* controller);
+
+void* run_controller(void* arg);
+
+void collect_stats(struct controller* controller, uint64_t interval_ns);
+
+void grow_pool(struct controller* controller);
+
+void shrink_pool(struct controller* controller);
+
+void free_controller(struct controller* controller);
+
+#endif // !CONTROLLER_H
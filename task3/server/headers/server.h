@@ -3,8 +3,15 @@
 
 #include "../../common/headers/common.h"
 #include "../../common/headers/endpoint.h"
+#include "../../common/headers/sockopt.h"
 #include "../../service/headers/service.h"
 #include "client.h"
+#include "conntable.h"
+#include "controller.h"
+#include "transport.h"
+#include "../../common/headers/payload.h"
+#include "../../common/headers/clock.h"
+#include <sys/epoll.h>
 
 /**
  * Used to create server on internet adress family (AF_INET) with
@@ -17,42 +24,60 @@ struct server {
   /* Endpoint of server */
   struct endpoint* endpoint;
 
-  /* Array of sub-servers (services) */
+  /* Array of sub-servers (services), MAX_SERVICES long */
   struct service** services; 
-  
-  /* Array of clients */
-  struct client** clients;
 
-  /* Mutex for message queue */
-  pthread_mutex_t msq_mutex;
+  /* Controller of services pool */
+  struct controller* controller;
+
+  /* Cache of responses shared by services, NULL if disabled */
+  struct response_cache* cache;
+
+  /* Transport to service processes, NULL if services are threads */
+  struct transport* transport;
   
-  /* Amount of services in array */
+  /* Table of connected clients */
+  struct conn_table* connections;
+
+  /* Amount of services in array, active ones are first */
   int services_amount;
   
-  /* Amount of currently connected clients */
-  int clients_amount;
+  /* Scheduler of requests for services */
+  struct scheduler* scheduler;
+
+  /* Worker for next connection */
+  int next_worker;
 
-  /* Message queue id */
-  int msqid;
+  /* Pool of buffers for request payloads */
+  struct payload_pool* pool;
+
+  /* Maximum length of message */
+  uint32_t max_message;
+
+  /* Epoll instance for listening and client sockets */
+  int epfd;
 
   /* Passive socket to accept connecitons */
   int sfd;
 };
 
-struct server* create_server(const char* ip, const int port, 
-    const char* msq_path, int services_amount);
+struct server* create_server(const char* ip, const int port, int services_amount);
 
 void run_server(struct server* server);
 
-void check_user_messages(struct server* server);
+void accept_clients(struct server* server);
 
-char* recv_message(struct client* client);
+void handle_client_data(struct server* server, struct client* client);
 
-void add_client(struct server* server, struct client* client);
+int recv_message(struct server* server, struct client* client, struct payload** payload);
+
+int add_client(struct server* server, struct client* client);
 
 void delete_client(struct server* server, struct client* client);
 
-void send_request(struct server* server, struct client* client, char* message); 
+void send_request(struct server* server, struct client* client, struct payload* payload); 
+
+void reject_request(struct client* client, uint64_t seq);
 
 void shutdown_connection(struct client* client);
 
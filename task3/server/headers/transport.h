@@ -0,0 +1,63 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include "../../common/headers/common.h"
+#include "../../common/headers/shmring.h"
+#include "../../common/headers/clock.h"
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sys/wait.h>
+#include <sys/prctl.h>
+#include <sched.h>
+#include <signal.h>
+
+struct server;
+struct client;
+struct payload;
+
+/**
+ * Used as transport between listener server and services
+ * running as separate processes. Request and reply rings
+ * live in memfd shared memory, mapped before fork, so
+ * descriptors and messages are copied to shared memory
+ * once. Services sleep on futex of request ring, listener
+ * is woken by eventfd registered in its epoll.
+ */
+struct transport {
+  /* Ring of requests, listener produces */
+  struct shm_ring* requests;
+
+  /* Ring of replies, services produce */
+  struct shm_ring* replies;
+
+  /* Shared memory mapping */
+  void* memory;
+
+  /* Size of mapping */
+  size_t size;
+
+  /* Process ids of services */
+  pid_t* pids;
+
+  /* Amount of service processes */
+  int processes;
+
+  /* File descriptor of shared memory */
+  int memfd;
+
+  /* Eventfd signaled when replies are published */
+  int efd;
+};
+
+struct transport* create_transport(int processes);
+
+void start_processes(struct transport* transport, struct server* server);
+
+int offload_request(struct transport* transport, struct client* client, 
+                    struct payload* payload);
+
+void drain_replies(struct server* server);
+
+void free_transport(struct transport* transport);
+
+#endif // !TRANSPORT_H
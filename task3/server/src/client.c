@@ -0,0 +1,440 @@
+#include "../headers/client.h"
+#include "../headers/server.h"
+#include "../../common/headers/payload.h"
+
+/* Amount of replies written with one sendmsg */
+#define WRITE_BATCH 32
+
+/*
+ * create_client - used to create an object of client struct
+ * for accepted connection. Listener owns first reference.
+ * @addr - pointer to address of the client
+ * @fd - file descriptor for communication
+ *
+ * Return: pointer to an object of client struct
+ */
+struct client* create_client(struct sockaddr_in* addr, int fd) {
+  struct client* client = (struct client*) calloc(1, sizeof(struct client));
+  if (!client)
+    print_error("calloc");
+
+  client->addr = *addr;
+  client->endpoint = atoe(&client->addr);
+  client->fd = fd;
+  client->header_size = sizeof(client->net_header[0]);
+  atomic_init(&client->refcount, 1);
+
+  if (pthread_mutex_init(&client->reply_mutex, NULL) != 0)
+    print_error("pthread_mutex_init");
+
+  return client;
+}
+
+/*
+ * hold_client - used to take one more reference to client.
+ * @client - pointer to an object of client struct
+ */
+void hold_client(struct client* client) {
+  atomic_fetch_add_explicit(&client->refcount, 1, memory_order_relaxed);
+}
+
+/*
+ * release_client - used to drop reference to client. Last
+ * reference closes connection and frees client, so its fd
+ * can not be reused while replies are pending.
+ * @client - pointer to an object of client struct
+ */
+void release_client(struct client* client) {
+  if (atomic_fetch_sub_explicit(&client->refcount, 1, memory_order_acq_rel) != 1)
+    return;
+
+  close(client->fd);
+  free_replies(client->pending);
+  free(client->output);
+  if (client->payload)
+    release_payload(client->payload);
+  pthread_mutex_destroy(&client->reply_mutex);
+  free_endpoint(client->endpoint);
+  free(client);
+}
+
+/*
+ * submit_replies - used to put replies to reorder buffer of
+ * client. Replies are sent strictly in order of requests by
+ * single writer: thread that finds nobody writing becomes
+ * writer and sends all replies that are ready, including
+ * ones submitted by other threads meanwhile. Writer never
+ * waits for socket: while socket is full, replies only wait
+ * in buffer and listener sends them when it is writable.
+ * @client - pointer to an object of client struct
+ * @replies - list of replies, buffer takes ownership
+ */
+void submit_replies(struct client* client, struct reply* replies) {
+  pthread_mutex_lock(&client->reply_mutex);
+  
+  /* Put replies to reorder buffer */
+  while (replies) {
+    struct reply* next = replies->next;
+    insert_reply(client, replies);
+    replies = next;
+  }
+  
+  /* Other thread is writer or socket is full */
+  if (client->writing || client->watching) {
+    pthread_mutex_unlock(&client->reply_mutex);
+    return;
+  }
+  
+  /* Become writer while there are ready replies */
+  client->writing = 1;
+  write_ready_replies(client);
+  client->writing = 0;
+
+  pthread_mutex_unlock(&client->reply_mutex);
+}
+
+/*
+ * defer_replies - used by listener to put replies to reorder
+ * buffer of client without writing them. Listener sends them
+ * when epoll reports that socket is writable, unless other
+ * thread is writer already.
+ * @client - pointer to an object of client struct
+ * @replies - list of replies, buffer takes ownership
+ */
+void defer_replies(struct client* client, struct reply* replies) {
+  pthread_mutex_lock(&client->reply_mutex);
+  
+  /* Put replies to reorder buffer */
+  while (replies) {
+    struct reply* next = replies->next;
+    insert_reply(client, replies);
+    replies = next;
+  }
+
+  /* Writer takes new replies itself */
+  if (!client->writing && !client->watching) {
+    client->watching = 1;
+    watch_output(client, 1);
+  }
+
+  pthread_mutex_unlock(&client->reply_mutex);
+}
+
+/*
+ * resume_replies - used by listener to continue writing
+ * replies when socket of client became writable.
+ * @client - pointer to an object of client struct
+ */
+void resume_replies(struct client* client) {
+  pthread_mutex_lock(&client->reply_mutex);
+
+  /* Writer sends replies itself */
+  if (!client->writing) {
+    client->writing = 1;
+    write_ready_replies(client);
+    client->writing = 0;
+  }
+
+  pthread_mutex_unlock(&client->reply_mutex);
+}
+
+/*
+ * write_ready_replies - used by writer to send rest of
+ * output buffer and replies that are ready. If socket gets
+ * full, listener is asked to resume when it is writable.
+ * Must be called with reply_mutex locked, mutex is released
+ * while writing.
+ * @client - pointer to an object of client struct
+ */
+void write_ready_replies(struct client* client) {
+  struct reply* ready;
+  int result;
+
+  do {
+    ready = take_ready_replies(client);
+    pthread_mutex_unlock(&client->reply_mutex);
+    result = write_replies(client, ready);
+    pthread_mutex_lock(&client->reply_mutex);
+  } while (result == 0 && client->pending && client->pending->seq == client->send_seq);
+
+  /* Watch socket only while output is waiting for it */
+  if ((result == 1) != client->watching) {
+    client->watching = (result == 1);
+    watch_output(client, client->watching);
+  }
+}
+
+/*
+ * watch_output - used to start or stop waiting for client
+ * socket to become writable in epoll of listener.
+ * @client - pointer to an object of client struct
+ * @enable - 1 to wait for writable socket, 0 to stop
+ */
+void watch_output(struct client* client, int enable) {
+  struct epoll_event ev;
+
+  ev.events = EPOLLIN | EPOLLRDHUP | (enable ? EPOLLOUT : 0);
+  ev.data.ptr = client;
+  
+  /* Listener may have already deleted connection */
+  if (epoll_ctl(client->server->epfd, EPOLL_CTL_MOD, client->fd, &ev) == -1 && errno != ENOENT)
+    print_error("epoll_ctl");
+}
+
+/*
+ * insert_reply - used to insert reply to reorder buffer
+ * sorted by sequence. Must be called with reply_mutex locked.
+ * @client - pointer to an object of client struct
+ * @reply - pointer to an object of reply struct
+ */
+void insert_reply(struct client* client, struct reply* reply) {
+  struct reply** place = &client->pending;
+
+  while (*place && (*place)->seq < reply->seq)
+    place = &(*place)->next;
+  
+  reply->next = *place;
+  *place = reply;
+}
+
+/*
+ * take_ready_replies - used to detach replies from reorder
+ * buffer that continue sequence of sent replies. Must be
+ * called with reply_mutex locked.
+ * @client - pointer to an object of client struct
+ *
+ * Return: list of replies in order, NULL if next reply is not ready
+ */
+struct reply* take_ready_replies(struct client* client) {
+  struct reply* ready = client->pending;
+  struct reply* last = NULL;
+  
+  while (client->pending && client->pending->seq == client->send_seq) {
+    last = client->pending;
+    client->pending = last->next;
+    client->send_seq++;
+  }
+
+  if (!last)
+    return NULL;
+
+  last->next = NULL;
+  return ready;
+}
+
+/*
+ * write_replies - used to send list of replies to client
+ * with length prefixes, WRITE_BATCH replies per call.
+ * Output buffer is sent first, so replies are appended to it
+ * while it is not empty. Bytes that socket did not accept are
+ * kept in output buffer. Replies of dropped requests only
+ * take their turn. Frees replies. If socket is broken,
+ * replies are dropped.
+ * @client - pointer to an object of client struct
+ * @replies - list of replies in order
+ *
+ * Return: 0 if everything is sent, 1 if output is waiting for
+ * socket, -1 if connection is broken
+ */
+int write_replies(struct client* client, struct reply* replies) {
+  struct iovec iov[2 * WRITE_BATCH];
+  uint32_t net_lens[WRITE_BATCH];
+  int result = client->broken ? -1 : flush_output(client);
+
+  while (replies) {
+    struct reply* first = replies;
+    int amount = 0, taken = 0;
+    
+    /* Collect replies for one call */
+    while (replies && amount < WRITE_BATCH) {
+      struct reply* reply = replies;
+      
+      replies = replies->next;
+      taken++;
+      if (!reply->data)
+        continue;
+
+      net_lens[amount] = htonl(reply->length);
+      iov[2 * amount].iov_base = &net_lens[amount];
+      iov[2 * amount].iov_len = sizeof(net_lens[amount]);
+      iov[2 * amount + 1].iov_base = reply->data;
+      iov[2 * amount + 1].iov_len = reply->length;
+      amount++;
+    }
+    
+    /* Send directly if nothing is waiting, keep the rest */
+    if (amount > 0 && result != -1) {
+      ssize_t bytes_send = result == 0 ? send_replies(client->fd, iov, 2 * amount) : 0;
+      
+      result = bytes_send == -1 ? -1 : queue_output(client, iov, 2 * amount, bytes_send);
+    }
+    
+    /* Client may be already disconnected or does not read */
+    if (result == -1 && !client->broken)
+      break_connection(client);
+    
+    /* Free written replies */
+    for (int i = 0; i < taken; i++) {
+      struct reply* next = first->next;
+      
+      if (!client->broken && first->data)
+        printf("SERVER: Send response to %s:%d : %s\n", 
+               client->endpoint->ip, client->endpoint->port,
+               first->data);
+      free(first->data);
+      free(first);
+      first = next;
+    }
+  }
+
+  if (result == -1 && !client->broken)
+    break_connection(client);
+
+  return result;
+}
+
+/*
+ * send_replies - used to send length prefixed replies to
+ * client in one call. Client socket is non-blocking and is
+ * never waited for, so only part of replies may be sent.
+ * @fd - file descriptor of client 
+ * @iov - array of length prefixes and replies
+ * @iovcnt - amount of elements in iov
+ *
+ * Return: amount of bytes sent, 0 if socket is full,
+ * -1 if connection is broken
+ */
+ssize_t send_replies(int fd, struct iovec* iov, int iovcnt) {
+  struct msghdr msg = { .msg_iov = iov, .msg_iovlen = iovcnt };
+  ssize_t bytes_send;
+  
+  while (1) {
+    bytes_send = sendmsg(fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (bytes_send != -1)
+      return bytes_send;
+    
+    /* Socket buffer is full */
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+      return 0;
+    else if (errno != EINTR)
+      return -1;
+  }
+}
+
+/*
+ * queue_output - used to append bytes of replies that socket
+ * did not accept to output buffer of client. Client that does
+ * not read its replies can not make buffer bigger than
+ * MAX_OUTPUT_SIZE.
+ * @client - pointer to an object of client struct
+ * @iov - array of length prefixes and replies
+ * @iovcnt - amount of elements in iov
+ * @skip - amount of bytes of iov already sent
+ *
+ * Return: 0 if nothing is left, 1 if bytes are waiting in
+ * buffer, -1 if buffer limit is exceeded
+ */
+int queue_output(struct client* client, struct iovec* iov, int iovcnt, size_t skip) {
+  size_t total = 0;
+
+  for (int i = 0; i < iovcnt; i++)
+    total += iov[i].iov_len;
+
+  if (skip >= total)
+    return 0;
+  
+  if (client->output_len - client->output_sent + total - skip > MAX_OUTPUT_SIZE)
+    return -1;
+
+  /* Move unsent bytes to start of buffer */
+  if (client->output_sent > 0) {
+    memmove(client->output, client->output + client->output_sent, 
+            client->output_len - client->output_sent);
+    client->output_len -= client->output_sent;
+    client->output_sent = 0;
+  }
+
+  /* Grow buffer */
+  if (client->output_len + total - skip > client->output_size) {
+    size_t size = client->output_size ? client->output_size * 2 : BUFFER_SIZE;
+    
+    while (size < client->output_len + total - skip)
+      size *= 2;
+    
+    client->output = (char*) realloc(client->output, size);
+    if (!client->output)
+      print_error("realloc");
+    client->output_size = size;
+  }
+  
+  /* Copy bytes that were not sent */
+  for (int i = 0; i < iovcnt; i++) {
+    size_t offset = skip < iov[i].iov_len ? skip : iov[i].iov_len;
+    
+    skip -= offset;
+    memcpy(client->output + client->output_len, 
+           (char*) iov[i].iov_base + offset, iov[i].iov_len - offset);
+    client->output_len += iov[i].iov_len - offset;
+  }
+
+  return 1;
+}
+
+/*
+ * flush_output - used to send output buffer of client as
+ * far as socket accepts it.
+ * @client - pointer to an object of client struct
+ *
+ * Return: 0 if buffer is empty, 1 if bytes are waiting
+ * for socket, -1 if connection is broken
+ */
+int flush_output(struct client* client) {
+  while (client->output_sent < client->output_len) {
+    ssize_t bytes_send = send(client->fd, client->output + client->output_sent,
+                              client->output_len - client->output_sent, 
+                              MSG_NOSIGNAL | MSG_DONTWAIT);
+    
+    if (bytes_send == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      return 1;
+    else if (bytes_send == -1 && errno == EINTR)
+      continue;
+    else if (bytes_send == -1)
+      return -1;
+
+    client->output_sent += bytes_send;
+  }
+
+  client->output_len = 0;
+  client->output_sent = 0;
+
+  return 0;
+}
+
+/*
+ * break_connection - used to drop replies of connection
+ * that is broken or does not read them. Connection is shut
+ * down, so listener sees disconnect and deletes it.
+ * @client - pointer to an object of client struct
+ */
+void break_connection(struct client* client) {
+  client->broken = 1;
+  client->output_len = 0;
+  client->output_sent = 0;
+  
+  printf("SERVER: Client %s:%d does not accept replies, closing\n", 
+         client->endpoint->ip, client->endpoint->port);
+  shutdown(client->fd, SHUT_RDWR);
+}
+
+/*
+ * free_replies - used to free list of replies.
+ * @replies - list of replies
+ */
+void free_replies(struct reply* replies) {
+  while (replies) {
+    struct reply* next = replies->next;
+    free(replies->data);
+    free(replies);
+    replies = next;
+  }
+}
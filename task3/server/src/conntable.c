@@ -0,0 +1,134 @@
+#include "../headers/conntable.h"
+
+/*
+ * create_conn_table - used to create an object of
+ * conn_table struct with all slots free.
+ * @capacity - maximum amount of connections
+ *
+ * Return: pointer to an object of conn_table struct
+ */
+struct conn_table* create_conn_table(int capacity) {
+  struct conn_table* table = (struct conn_table*) malloc(sizeof(struct conn_table));
+  if (!table)
+    print_error("malloc");
+
+  table->slots = (struct conn_slot*) malloc(capacity * sizeof(struct conn_slot));
+  if (!table->slots)
+    print_error("malloc");
+  
+  /* Link all slots to free list */
+  for (int i = 0; i < capacity; i++) {
+    table->slots[i].client = NULL;
+    table->slots[i].generation = 1;
+    table->slots[i].next_free = i + 1 < capacity ? i + 1 : -1;
+  }
+  
+  table->capacity = capacity;
+  table->amount = 0;
+  table->free_head = capacity > 0 ? 0 : -1;
+
+  if (pthread_mutex_init(&table->mutex, NULL) != 0)
+    print_error("pthread_mutex_init");
+
+  return table;
+}
+
+/*
+ * register_client - used to put client to free slot
+ * of table.
+ * @table - pointer to an object of conn_table struct
+ * @client - pointer to an object of client struct
+ *
+ * Return: handle of connection, INVALID_HANDLE if table is full
+ */
+uint64_t register_client(struct conn_table* table, struct client* client) {
+  uint64_t handle;
+  int index;
+
+  pthread_mutex_lock(&table->mutex);
+  
+  /* Table is full */
+  if (table->free_head == -1) {
+    pthread_mutex_unlock(&table->mutex);
+    return INVALID_HANDLE;
+  }
+  
+  /* Take first free slot */
+  index = table->free_head;
+  table->free_head = table->slots[index].next_free;
+  table->slots[index].client = client;
+  table->amount++;
+  
+  handle = ((uint64_t) table->slots[index].generation << 32) | (uint32_t) index;
+
+  pthread_mutex_unlock(&table->mutex);
+
+  return handle;
+}
+
+/*
+ * unregister_client - used to free slot of connection.
+ * Generation of slot is changed, so handle becomes stale.
+ * Reference of client is not released.
+ * @table - pointer to an object of conn_table struct
+ * @handle - handle of connection
+ */
+void unregister_client(struct conn_table* table, uint64_t handle) {
+  uint32_t index = (uint32_t) handle;
+  uint32_t generation = handle >> 32;
+  
+  pthread_mutex_lock(&table->mutex);
+  
+  if (index < (uint32_t) table->capacity && table->slots[index].generation == generation) {
+    table->slots[index].client = NULL;
+    
+    /* Skip 0, so handle is never INVALID_HANDLE */
+    if (++table->slots[index].generation == 0)
+      table->slots[index].generation = 1;
+    
+    /* Return slot to free list */
+    table->slots[index].next_free = table->free_head;
+    table->free_head = index;
+    table->amount--;
+  }
+
+  pthread_mutex_unlock(&table->mutex);
+}
+
+/*
+ * resolve_client - used to get client by handle. Returned
+ * client is held and should be released manually.
+ * @table - pointer to an object of conn_table struct
+ * @handle - handle of connection
+ *
+ * Return: pointer to an object of client struct, NULL if
+ * handle is stale
+ */
+struct client* resolve_client(struct conn_table* table, uint64_t handle) {
+  uint32_t index = (uint32_t) handle;
+  uint32_t generation = handle >> 32;
+  struct client* client = NULL;
+
+  pthread_mutex_lock(&table->mutex);
+  
+  if (index < (uint32_t) table->capacity && table->slots[index].generation == generation) {
+    client = table->slots[index].client;
+    if (client)
+      hold_client(client);
+  }
+
+  pthread_mutex_unlock(&table->mutex);
+
+  return client;
+}
+
+/*
+ * free_conn_table - used to free allocated memory
+ * for conn_table struct. Clients are not released.
+ * @table - pointer to an object of conn_table struct
+ */
+void free_conn_table(struct conn_table* table) {
+  pthread_mutex_destroy(&table->mutex);
+  free(table->slots);
+  free(table);
+}
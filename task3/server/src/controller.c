@@ -0,0 +1,167 @@
+#include "../headers/controller.h"
+#include "../headers/server.h"
+#include <inttypes.h>
+#include <time.h>
+
+/*
+ * create_controller - used to create an object of
+ * controller struct for pool of server.
+ * @server - pointer to an object of server struct
+ *
+ * Return: pointer to an object of controller struct
+ */
+struct controller* create_controller(struct server* server) {
+  struct controller* controller = (struct controller*) calloc(1, sizeof(struct controller));
+  if (!controller)
+    print_error("calloc");
+
+  controller->server = server;
+
+  return controller;
+}
+
+/*
+ * start_controller - used to start thread of controller.
+ * @controller - pointer to an object of controller struct
+ */
+void start_controller(struct controller* controller) {
+  if (pthread_create(&controller->thread, NULL, run_controller, (void *) controller) != 0)
+    print_error("pthread_create");
+  controller->running = 1;
+}
+
+/*
+ * run_controller - used to resize pool of services by load.
+ * Wakes up every CONTROL_INTERVAL_MS, collects statistics
+ * and grows or shrinks pool by one service.
+ * @arg - pointer that casted to controller struct inside
+ */
+void* run_controller(void* arg) {
+  struct controller* controller = (struct controller*) arg;
+  struct scheduler* scheduler = controller->server->scheduler;
+  struct timespec interval = {
+    .tv_sec = CONTROL_INTERVAL_MS / 1000,
+    .tv_nsec = (CONTROL_INTERVAL_MS % 1000) * 1000000L,
+  };
+  uint64_t last = monotonic_ns();
+
+  while (1) {
+    nanosleep(&interval, NULL);
+
+    uint64_t now = monotonic_ns();
+    collect_stats(controller, now - last);
+    last = now;
+
+    int active = atomic_load(&scheduler->active);
+
+    /* Requests wait too long while services are busy */
+    if (controller->wait_p99_us > WAIT_TARGET_US && 
+        controller->utilization >= LOW_UTILIZATION)
+      controller->high_periods++;
+    else
+      controller->high_periods = 0;
+
+    /* Services are mostly idle */
+    if (controller->utilization < LOW_UTILIZATION)
+      controller->low_periods++;
+    else
+      controller->low_periods = 0;
+    
+    if (controller->high_periods >= GROW_PERIODS && active < MAX_SERVICES)
+      grow_pool(controller);
+    else if (controller->low_periods >= SHRINK_PERIODS && active > MIN_SERVICES)
+      shrink_pool(controller);
+  }
+
+  return NULL;
+}
+
+/*
+ * collect_stats - used to gather and reset statistics of
+ * services. Computes p99 of queue wait from histograms and
+ * utilization of active services.
+ * @controller - pointer to an object of controller struct
+ * @interval_ns - time since last collection (ns)
+ */
+void collect_stats(struct controller* controller, uint64_t interval_ns) {
+  struct server* server = controller->server;
+  uint64_t hist[WAIT_BUCKETS] = { 0 };
+  uint64_t total = 0, busy_ns = 0, seen = 0;
+  int active = atomic_load(&server->scheduler->active);
+  
+  /* Sum statistics of all services, retired may still work */
+  for (int i = 0; i < server->services_amount; i++) {
+    struct service_stats* stats = &server->services[i]->stats;
+
+    for (int j = 0; j < WAIT_BUCKETS; j++)
+      hist[j] += atomic_exchange_explicit(&stats->wait_hist[j], 0, memory_order_relaxed);
+    busy_ns += atomic_exchange_explicit(&stats->busy_ns, 0, memory_order_relaxed);
+  }
+  
+  for (int j = 0; j < WAIT_BUCKETS; j++)
+    total += hist[j];
+  
+  /* Upper bound of bucket with 99th percentile */
+  controller->wait_p99_us = 0;
+  for (int j = 0; j < WAIT_BUCKETS && total > 0; j++) {
+    seen += hist[j];
+    if (seen * 100 >= total * 99) {
+      controller->wait_p99_us = 1ULL << j;
+      break;
+    }
+  }
+
+  controller->utilization = (int) (busy_ns * 100 / (interval_ns * (uint64_t) active));
+}
+
+/*
+ * grow_pool - used to add one service to pool.
+ * @controller - pointer to an object of controller struct
+ */
+void grow_pool(struct controller* controller) {
+  struct server* server = controller->server;
+  int active = atomic_load(&server->scheduler->active);
+  
+  /* Activate worker, then make sure its thread runs */
+  atomic_store(&server->scheduler->active, active + 1);
+  start_service(server->services[active]);
+
+  controller->grows++;
+  controller->high_periods = 0;
+  controller->low_periods = 0;
+
+  printf("CONTROLLER: Pool grew to %d services (p99 wait %" PRIu64 " us, utilization %d%%)\n",
+         active + 1, controller->wait_p99_us, controller->utilization);
+}
+
+/*
+ * shrink_pool - used to retire last service of pool.
+ * Service leaves when its queue is empty.
+ * @controller - pointer to an object of controller struct
+ */
+void shrink_pool(struct controller* controller) {
+  struct server* server = controller->server;
+  int active = atomic_load(&server->scheduler->active);
+  
+  /* Deactivate worker and wake it to leave */
+  atomic_store(&server->scheduler->active, active - 1);
+  wake_worker(server->scheduler, active - 1);
+
+  controller->shrinks++;
+  controller->high_periods = 0;
+  controller->low_periods = 0;
+
+  printf("CONTROLLER: Pool shrank to %d services (p99 wait %" PRIu64 " us, utilization %d%%)\n",
+         active - 1, controller->wait_p99_us, controller->utilization);
+}
+
+/*
+ * free_controller - used to stop controller and free
+ * allocated memory for controller struct.
+ * @controller - pointer to an object of controller struct
+ */
+void free_controller(struct controller* controller) {
+  if (controller->running)
+    pthread_cancel(controller->thread);
+  free(controller);
+}
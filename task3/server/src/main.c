@@ -5,7 +5,7 @@ struct server* server;
 void cleanup();
 
 int main(void) {
-  server = create_server(SERVER_IP, SERVER_PORT, MSQ_FILE, SERVICES_AMOUNT);
+  server = create_server(SERVER_IP, SERVER_PORT, SERVICES_AMOUNT);
   atexit(cleanup);
   run_server(server); 
   exit(EXIT_SUCCESS);
@@ -5,41 +5,53 @@
  * struct, initializes its fields.
  * @ip - ip address of the server 
  * @port - port of the server
- * @msq_path - path for file to open msq with
- * @services_amount - amount of services to create
+ * @services_amount - amount of services to start with
  *
  * Return: pointer to an object of server struct 
  */
-struct server* create_server(const char* ip, const int port, const char* msq_path, int services_amount) {
-  key_t key;
+struct server* create_server(const char* ip, const int port, int services_amount) {
   struct server* server = (struct server*) malloc(sizeof(struct server));
   if (!server)
     print_error("malloc");
   
-  /* Create message queue */
-  key = ftok(msq_path, 1);
-  if (key == -1)
-    print_error("ftok");
+  /* Pool size stays within bounds */
+  if (services_amount < MIN_SERVICES)
+    services_amount = MIN_SERVICES;
+  if (services_amount > MAX_SERVICES)
+    services_amount = MAX_SERVICES;
+
+  /* Create queues of services */
+  server->scheduler = create_scheduler(MAX_SERVICES, services_amount, QUEUE_SIZE);
+  server->next_worker = 0;
+  
+  /* Create pool for payloads */
+  server->pool = create_payload_pool();
   
-  server->msqid = msgget(key, IPC_CREAT | 0666); 
-  if (server->msqid == -1)
-    print_error("msgget");
+  /* Initialize table of clients */
+  server->connections = create_conn_table(MAX_CLIENTS);
   
-  /* Initialize mutex */
-  if (pthread_mutex_init(&server->msq_mutex, NULL) != 0)
-    print_error("pthread_mutex_init");
+  /* Initialize cache of responses */
+  server->cache = RESPONSE_CACHE ? create_cache(CACHE_BUDGET) : NULL;
   
-  /* Initialize services */
-  server->services = (struct service**) malloc(services_amount * sizeof(struct service*)); 
-  server->services_amount = services_amount;
+  /* Initialize services, only active ones are started */
+  server->services = (struct service**) malloc(MAX_SERVICES * sizeof(struct service*)); 
+  server->services_amount = MAX_SERVICES;
   for (int i = 0; i < server->services_amount; i++) {
-    server->services[i] = create_service(server->msqid, server->msq_mutex, i + 1); 
+    server->services[i] = create_service(server->scheduler, server->connections, i); 
+    server->services[i]->cache = server->cache;
+  }
+  
+  /* Initialize controller of pool */
+  server->controller = create_controller(server);
+  
+  /* Services run as processes, messages should fit slot */
+  server->transport = NULL;
+  server->max_message = MAX_MESSAGE_SIZE;
+  if (PROCESS_SERVICES) {
+    server->transport = create_transport(services_amount);
+    server->max_message = SHM_MESSAGE_SIZE;
   }
   
-  /* Initialize clients array*/
-  server->clients = (struct client**) malloc(CLIENTS_AMOUNT * sizeof(struct client*));
-  server->clients_amount = 0; 
-
   /* Initialzie sockaddr_un struct */
   server->serv.sin_family = AF_INET;
   server->serv.sin_addr.s_addr = inet_addr(ip); 
@@ -52,21 +64,39 @@ struct server* create_server(const char* ip, const int port, const char* msq_pat
   server->sfd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
   if (server->sfd == -1)
     print_error("socket");
+  
+  /* Create epoll instance */
+  server->epfd = epoll_create1(0);
+  if (server->epfd == -1)
+    print_error("epoll_create1");
 
   return server;
 }
 
 /*
- * run_server - used to bind server, set it
- * to passive mode, accept connection and check for new
- * messages.
+ * run_server - used to bind server, set it to passive
+ * mode and run epoll reactor. Listening socket and client
+ * sockets are registered in epoll, so only readable
+ * connections are read and idle server sleeps in epoll_wait.
+ * Client sockets that got full are watched for writability
+ * until their waiting replies are sent.
  * @server - pointer to an object of server struct
  */
 void run_server(struct server* server) {
+  struct epoll_event ev, events[MAX_EVENTS];
+  int nfds;
+  
+  /* Fork service processes before socket starts listening */
+  if (server->transport)
+    start_processes(server->transport, server);
+
   /* Bind Endpoint to socket */
   if (bind(server->sfd, (struct sockaddr*) &server->serv, sizeof(server->serv)) == -1)
     print_error("bind");
   
+  /* Accept requests in SYN */
+  set_fastopen(server->sfd);
+
   /* Set socket to passive mode */
   if (listen(server->sfd, CLIENTS_AMOUNT) == -1)
     print_error("listen");
@@ -75,187 +105,322 @@ void run_server(struct server* server) {
          inet_ntoa(server->serv.sin_addr), 
          ntohs(server->serv.sin_port));
   
-  /* Run services */
-  for (int i = 0; i < server->services_amount; i++) {
-    if (pthread_create(&server->services[i]->thread, NULL, 
-                   run_service, (void *) server->services[i]) != 0)
-      print_error("pthread_create");
+  /* Run active services and controller of pool */
+  if (!server->transport) {
+    for (int i = 0; i < atomic_load(&server->scheduler->active); i++)
+      start_service(server->services[i]);
+    start_controller(server->controller);
   }
   
-  /* Accept connections */
+  /* Register listening socket, NULL marks it in events */
+  ev.events = EPOLLIN;
+  ev.data.ptr = NULL;
+  if (epoll_ctl(server->epfd, EPOLL_CTL_ADD, server->sfd, &ev) == -1)
+    print_error("epoll_ctl");
+  
+  /* Register eventfd of replies, transport marks it in events */
+  if (server->transport) {
+    ev.events = EPOLLIN;
+    ev.data.ptr = server->transport;
+    if (epoll_ctl(server->epfd, EPOLL_CTL_ADD, server->transport->efd, &ev) == -1)
+      print_error("epoll_ctl");
+  }
+  
+  /* Wait for events */
+  while (1) {
+    nfds = epoll_wait(server->epfd, events, MAX_EVENTS, -1);
+    if (nfds == -1) {
+      if (errno == EINTR)
+        continue;
+      print_error("epoll_wait");
+    }
+
+    for (int i = 0; i < nfds; i++) {
+      /* New connections */
+      if (events[i].data.ptr == NULL)
+        accept_clients(server);
+      /* Replies from service processes */
+      else if (events[i].data.ptr == server->transport)
+        drain_replies(server);
+      else {
+        struct client* client = (struct client*) events[i].data.ptr;
+        
+        /* Socket is writable again, send waiting replies */
+        if (events[i].events & EPOLLOUT)
+          resume_replies(client);
+        /* Data or disconnect from client */
+        if (events[i].events & ~EPOLLOUT)
+          handle_client_data(server, client);
+      }
+    }
+  }
+}
+
+/*
+ * accept_clients - used to accept all pending connections
+ * and register them in epoll.
+ * @server - pointer to an object of server struct
+ */
+void accept_clients(struct server* server) {
   while (1) {
     struct sockaddr_in addr;
     socklen_t client_size = sizeof(addr);
-
     int client_fd;
-    client_fd = accept(server->sfd, (struct sockaddr*) &addr, &client_size);
+
+    client_fd = accept4(server->sfd, (struct sockaddr*) &addr, &client_size, SOCK_NONBLOCK);
+    
+    /* No more pending connections */
+    if (client_fd == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      return;
     
-    if (client_fd == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) { 
-      check_user_messages(server); 
-      continue;
-    }
-   
     /* Error occured */
     if (client_fd == -1) {
-      print_error("accept");
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      print_error("accept4");
     }
-    /* Message received */
-    else {
-      struct client* client = (struct client*) malloc(sizeof(struct client));
-      
-      /* Initialize client */
-      client->addr = &addr; 
-      client->endpoint = atoe(&addr);
-      client->fd = client_fd;
     
-      /* Log client conncection */
-      printf("SERVER: Client %s:%d connected\n", 
+    /* Initialize client */
+    struct client* client = create_client(&addr, client_fd);
+    
+    /* Server is full */
+    if (add_client(server, client) == -1) {
+      printf("SERVER: Client %s:%d rejected, server is full\n", 
              client->endpoint->ip, client->endpoint->port);
-      
-      /* Add client to collection */
-      add_client(server, client);
+      release_client(client);
+      continue;
     }
+    
+    /* Log client conncection */
+    printf("SERVER: Client %s:%d connected\n", 
+           client->endpoint->ip, client->endpoint->port);
   }
 }
 
 /*
- * check_user_messages - used to check for new messages
- * from connected users.
+ * handle_client_data - used to read all available messages
+ * from readable client and pass them to services. Closes
+ * connection if client disconnected.
  * @server - pointer to an object of server struct
+ * @client - pointer to an object of client struct
  */
-void check_user_messages(struct server* server) {
-  for (int i = 0; i < server->clients_amount; i++) {
-    struct client* client = server->clients[i];
-    char* message = recv_message(client);
+void handle_client_data(struct server* server, struct client* client) {
+  struct payload* payload;
+  int result;
 
-    if (message != NULL) {
-      send_request(server, client, message); 
-    }
-    else {
-      if (!(errno == EAGAIN || errno == EWOULDBLOCK)) {
-        close_connection(client);
-        delete_client(server, client);
-      }
-    }
+  /* Request takes reference to payload */
+  while ((result = recv_message(server, client, &payload)) == 1)
+    send_request(server, client, payload);
+  
+  /* Connection closed */
+  if (result == -1) {
+    printf("SERVER: Client %s:%d disconnected\n", 
+           client->endpoint->ip, client->endpoint->port);
+    delete_client(server, client);
   }
 }
 
 /*
- * send_request - used to send request to services.
+ * send_request - used to send request descriptor to worker
+ * of connection. Request is stamped with sequence number and
+ * handle of connection and put to lane of its QoS class.
+ * Connection of retired worker moves to active one. If
+ * services are processes, message is copied to request ring
+ * instead. Listener never waits for full queue, client gets
+ * "overloaded" reply instead.
  * @server - pointer to an object of server struct
  * @client - pointer to an object of client struct
- * @message - message that client sent
+ * @payload - buffer with message, reference is passed to request
  */
-void send_request(struct server* server, struct client* client, char* message) {
-  struct msg msg;
+void send_request(struct server* server, struct client* client, struct payload* payload) {
+  struct user_request request;
+  int active = atomic_load(&server->scheduler->active);
   
-  msg.mtype = 1;
-  msg.payload.client = *client;
-  strncpy(msg.payload.message, message, sizeof(msg.payload.message));
+  /* Ring may be full of replies, drain them once before giving up */
+  if (server->transport) {
+    if (offload_request(server->transport, client, payload) == -1) {
+      drain_replies(server);
+      if (offload_request(server->transport, client, payload) == -1)
+        reject_request(client, client->next_seq++);
+    }
+    release_payload(payload);
+    return;
+  }
+  
+  /* Worker of connection was retired */
+  if (client->worker >= active)
+    client->worker = client->worker % active;
 
-  if (msgsnd(server->msqid, &msg, sizeof(msg), 0) == -1)
-    print_error("msgsnd");
+  request.payload = payload;
+  request.handle = client->handle;
+  request.seq = client->next_seq++;
+  request.offset = 0;
+  request.length = client->message_len;
+  request.timestamp = monotonic_ns();
+  request.deadline = client->deadline;
+
+  if (schedule_request(server->scheduler, client->worker, &request, client->qos) == -1) {
+    reject_request(client, request.seq);
+    release_payload(payload);
+  }
 } 
 
 /*
- * recv_message - used to receive message from client. Receives
- * message length first, then allocates memory for message and
- * receives full message. Returned message should be freed manually.
+ * reject_request - used to answer "overloaded" to request
+ * that did not fit queue. Reply takes turn of request. It is
+ * only put to reorder buffer, listener sends it when socket
+ * is writable, so overloaded client can not stall listener.
+ * @client - pointer to an object of client struct
+ * @seq - sequence number of request
+ */
+void reject_request(struct client* client, uint64_t seq) {
+  struct reply* reply = (struct reply*) malloc(sizeof(struct reply));
+  if (!reply)
+    print_error("malloc");
+
+  reply->seq = seq;
+  reply->data = strdup(OVERLOADED_REPLY);
+  if (!reply->data)
+    print_error("strdup");
+  reply->length = strlen(reply->data);
+  reply->next = NULL;
+
+  defer_replies(client, reply);
+}
+
+/*
+ * recv_message - used to receive message from non-blocking
+ * client socket. Receives frame header first: message
+ * length in low 24 bits and QoS class in high byte. If
+ * FRAME_DEADLINE flag is set in high byte, header is followed
+ * by time in ms client waits for reply. Then takes
+ * buffer of that size from payload pool and receives message
+ * into it. Partial message is kept in client struct until rest
+ * of it arrives. Returned payload has one reference that
+ * should be released manually.
+ * @server - pointer to an object of server struct
  * @client - pointer to an object of client struct
+ * @payload - pointer to store buffer with received message
  *
- * Return: string (message) if successful, NULL if connection closed 
+ * Return: 1 if message received, 0 if more data is needed,
+ * -1 if connection closed or message is too big
  */
-char* recv_message(struct client* client) {
-  uint32_t net_len;
-  uint32_t message_len;
+int recv_message(struct server* server, struct client* client, struct payload** payload) {
   ssize_t bytes_read;
-  ssize_t total_received;
-  char* message;
-  
-  /* Receive message length */
-  bytes_read = recv(client->fd, &net_len, sizeof(net_len), MSG_DONTWAIT);
   
-  /* Error occured*/
-  if (bytes_read < 0) {
-    if (errno == EAGAIN || errno == EWOULDBLOCK)
-      return NULL;     
+  /* Receive frame header */
+  while (client->payload == NULL) {
+    bytes_read = recv(client->fd, (char*) client->net_header + client->header_received, 
+                      client->header_size - client->header_received, 0);
+    if (bytes_read == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      return 0;
+    else if (bytes_read == -1 && errno == EINTR)
+      continue;
+    else if (bytes_read <= 0)
+      return -1;
 
-    print_error("recv");
-  } 
-  /* Connection closed */
-  else if (bytes_read == 0) {
-    return NULL;
+    client->header_received += bytes_read;
+    if (client->header_received < client->header_size)
+      continue;
+    
+    /* Convert header to Little Endian and split it */
+    uint32_t header = ntohl(client->net_header[0]);
+    
+    /* Deadline follows length */
+    if ((header >> FRAME_CLASS_SHIFT) & FRAME_DEADLINE && 
+        client->header_size < sizeof(client->net_header)) {
+      client->header_size = sizeof(client->net_header);
+      continue;
+    }
+    
+    client->message_len = header & FRAME_LENGTH_MASK;
+    client->qos = (header >> FRAME_CLASS_SHIFT) & FRAME_CLASS_MASK;
+    client->deadline = 0;
+    if (client->header_size == sizeof(client->net_header))
+      client->deadline = monotonic_ns() + ntohl(client->net_header[1]) * 1000000ULL;
+    client->message_received = 0;
+    if (client->message_len > server->max_message)
+      return -1;
+    
+    /* Take buffer for message */
+    client->payload = alloc_payload(server->pool, client->message_len + 1);
   }
   
-  /* Convert message length to Little Endian */
-  message_len = ntohl(net_len);
-  
-  /* Allocate memory for message */
-  message = (char*) malloc(message_len + 1);
-  if (!message)
-    print_error("malloc");
-  
-  /* Read all message */
-  while (total_received < message_len) {
-    bytes_read = recv(client->fd, message + total_received, message_len - total_received, 0);
-    if (bytes_read < 0) {
-      free(message);
-      print_error("recv");
-    }
-    total_received += bytes_read;
+  /* Read rest of message */
+  while (client->message_received < client->message_len) {
+    bytes_read = recv(client->fd, client->payload->data + client->message_received, 
+                      client->message_len - client->message_received, 0);
+    if (bytes_read == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      return 0;
+    else if (bytes_read == -1 && errno == EINTR)
+      continue;
+    else if (bytes_read <= 0)
+      return -1;
+
+    client->message_received += bytes_read;
   }
   
   /* Terminate message */
-  message[message_len] = '\0';
+  client->payload->data[client->message_len] = '\0';
+  *payload = client->payload;
   
-  return message;
+  /* Wait for next frame header */
+  client->payload = NULL;
+  client->header_received = 0;
+  client->header_size = sizeof(client->net_header[0]);
+  
+  return 1;
 }
 
 /*
- * add_client - used to add client object to array
- * of clients.
+ * add_client - used to add client object to table
+ * of clients and register its socket in epoll.
  * @server - pointer to an object of server struct
  * @client - pointer to an object of client struct  
+ *
+ * Return: 0 if successful, -1 if server is full
  */
-void add_client(struct server* server, struct client* client) {
-  /* Check if server is full */
-  if (server->clients_amount == CLIENTS_AMOUNT)
-    return;
+int add_client(struct server* server, struct client* client) {
+  struct epoll_event ev;
+
+  /* Add client to table, fails if server is full */
+  client->handle = register_client(server->connections, client);
+  if (client->handle == INVALID_HANDLE)
+    return -1;
 
-  client->id = server->clients_amount;
   client->server = server;
   
-  /* Add client to array*/
-  server->clients[server->clients_amount] = client;
-  server->clients_amount++;
+  /* Bind connection to worker */
+  client->worker = server->next_worker;
+  server->next_worker = (server->next_worker + 1) % atomic_load(&server->scheduler->active);
+  
+  /* Watch client for data */
+  ev.events = EPOLLIN | EPOLLRDHUP;
+  ev.data.ptr = client;
+  if (epoll_ctl(server->epfd, EPOLL_CTL_ADD, client->fd, &ev) == -1)
+    print_error("epoll_ctl");
+
+  return 0;
 }
 
 /*
  * delete_client - used to delete client object from
- * array of clients.
+ * table of clients and epoll. Handle of client becomes
+ * stale, so replies of pending requests are dropped. Socket
+ * is closed when last thread sending replies releases it.
  * @server - pointer to an object of server struct
  * @client - pointer to an object of client struct
  */
 void delete_client(struct server* server, struct client* client) {
-  int i;
+  /* Make handle stale */
+  unregister_client(server->connections, client->handle);
   
-  /* Find necessary client */
-  for (i = 0; i < server->clients_amount; i++) {
-    if (server->clients[i]->id == client->id) {
-      free_endpoint(server->clients[i]->endpoint);
-      free(server->clients[i]);
-      break;
-    } 
-  }
-
-  /* Move i + 1 clients to left */
-  for (; i < server->clients_amount; i++) {
-     server->clients[i] = server->clients[i + 1]; 
-  }
+  /* Stop watching client, socket may stay open for replies */
+  if (epoll_ctl(server->epfd, EPOLL_CTL_DEL, client->fd, NULL) == -1)
+    print_error("epoll_ctl");
   
-  /* Delete last pointer */
-  server->clients[i + 1] = NULL; 
-  server->clients_amount--;
+  /* Drop reference of listener */
+  release_client(client);
 }
 
 /*
@@ -273,10 +438,18 @@ void shutdown_connection(struct client* client) {
  */
 void free_server(struct server* server) {
   free_endpoint(server->endpoint);
+  free_controller(server->controller);
+  if (server->transport)
+    free_transport(server->transport);
+  close(server->epfd);
+  close(server->sfd);
   for (int i = 0; i < server->services_amount; i++) {
     free_service(server->services[i]);
   }
-  pthread_mutex_destroy(&server->msq_mutex);
-  msgctl(server->msqid, IPC_RMID, NULL);
+  free_scheduler(server->scheduler);
+  free_conn_table(server->connections);
+  if (server->cache)
+    free_cache(server->cache);
+  free_payload_pool(server->pool);
   free(server);
 }
@@ -0,0 +1,190 @@
+#include "../headers/transport.h"
+#include "../headers/server.h"
+
+/*
+ * create_transport - used to create an object of transport
+ * struct. Creates shared memory with request and reply
+ * rings and eventfd for replies.
+ * @processes - amount of service processes
+ *
+ * Return: pointer to an object of transport struct
+ */
+struct transport* create_transport(int processes) {
+  struct transport* transport = (struct transport*) malloc(sizeof(struct transport));
+  size_t ring_size = shm_ring_bytes(SHM_RING_SIZE, SHM_SLOT_SIZE);
+  if (!transport)
+    print_error("malloc");
+
+  transport->pids = (pid_t*) calloc(processes, sizeof(pid_t));
+  if (!transport->pids)
+    print_error("calloc");
+  transport->processes = processes;
+  
+  /* Create shared memory for both rings */
+  transport->size = 2 * ring_size;
+  transport->memfd = memfd_create("task3-rings", MFD_CLOEXEC);
+  if (transport->memfd == -1)
+    print_error("memfd_create");
+  if (ftruncate(transport->memfd, transport->size) == -1)
+    print_error("ftruncate");
+  
+  transport->memory = mmap(NULL, transport->size, PROT_READ | PROT_WRITE, 
+                           MAP_SHARED, transport->memfd, 0);
+  if (transport->memory == MAP_FAILED)
+    print_error("mmap");
+
+  /* Place rings */
+  transport->requests = (struct shm_ring*) transport->memory;
+  transport->replies = (struct shm_ring*) ((char*) transport->memory + ring_size);
+  init_shm_ring(transport->requests, SHM_RING_SIZE, SHM_SLOT_SIZE);
+  init_shm_ring(transport->replies, SHM_RING_SIZE, SHM_SLOT_SIZE);
+  
+  /* Create eventfd for replies */
+  transport->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (transport->efd == -1)
+    print_error("eventfd");
+
+  return transport;
+}
+
+/*
+ * start_processes - used to fork service processes. Every
+ * process is pinned to its own CPU and dies with listener.
+ * Should be called before listening socket is created.
+ * @transport - pointer to an object of transport struct
+ * @server - pointer to an object of server struct
+ */
+void start_processes(struct transport* transport, struct server* server) {
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  pid_t parent = getpid();
+  
+  /* Do not duplicate buffered output in children */
+  fflush(stdout);
+
+  for (int i = 0; i < transport->processes; i++) {
+    pid_t pid = fork();
+    if (pid == -1)
+      print_error("fork");
+    
+    if (pid == 0) {
+      /* Die with listener */
+      prctl(PR_SET_PDEATHSIG, SIGTERM);
+      if (getppid() != parent)
+        _exit(EXIT_SUCCESS);
+      
+      /* Pin process to CPU */
+      if (cpus > 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(i % cpus, &set);
+        sched_setaffinity(0, sizeof(set), &set);
+      }
+      
+      /* Sockets of listener are not needed */
+      close(server->sfd);
+      close(server->epfd);
+
+      run_process_service(transport, i + 1);
+      _exit(EXIT_SUCCESS);
+    }
+
+    transport->pids[i] = pid;
+  }
+}
+
+/*
+ * offload_request - used to copy request to request ring
+ * without blocking.
+ * @transport - pointer to an object of transport struct
+ * @client - pointer to an object of client struct
+ * @payload - buffer with message
+ *
+ * Return: 0 if successful, -1 if ring is full
+ */
+int offload_request(struct transport* transport, struct client* client, 
+                    struct payload* payload) {
+  struct shm_slot* slot = reserve_slot(transport->requests);
+  if (!slot)
+    return -1;
+
+  slot->handle = client->handle;
+  slot->seq = client->next_seq++;
+  slot->timestamp = monotonic_ns();
+  slot->deadline = client->deadline;
+  slot->length = client->message_len;
+  memcpy(slot->data, payload->data, client->message_len);
+  slot->data[client->message_len] = '\0';
+
+  publish_slot(transport->requests, slot);
+
+  return 0;
+}
+
+/*
+ * drain_replies - used to take all replies from reply ring
+ * and pass them to reorder buffers of their connections.
+ * Listener does not write them here: they are sent when
+ * epoll reports socket writable, so full client socket can
+ * not stall listener and reply ring. Replies of closed
+ * connections are dropped.
+ * @server - pointer to an object of server struct
+ */
+void drain_replies(struct server* server) {
+  struct transport* transport = server->transport;
+  struct shm_slot* slot;
+  uint64_t counter;
+  
+  /* Reset eventfd before draining, so later publish signals again */
+  if (read(transport->efd, &counter, sizeof(counter)) == -1 && errno != EAGAIN)
+    print_error("read");
+
+  while ((slot = try_take_slot(transport->replies)) != NULL) {
+    struct client* client = resolve_client(server->connections, slot->handle);
+
+    if (client) {
+      struct reply* reply = (struct reply*) malloc(sizeof(struct reply));
+      if (!reply)
+        print_error("malloc");
+      
+      reply->seq = slot->seq;
+      reply->length = 0;
+      reply->data = NULL;
+      reply->next = NULL;
+      
+      /* Copy reply, unless request was dropped */
+      if (!slot->dropped) {
+        reply->length = slot->length;
+        reply->data = (char*) malloc(slot->length + 1);
+        if (!reply->data)
+          print_error("malloc");
+        memcpy(reply->data, slot->data, slot->length);
+        reply->data[slot->length] = '\0';
+      }
+
+      defer_replies(client, reply);
+      release_client(client);
+    }
+
+    release_slot(transport->replies, slot);
+  }
+}
+
+/*
+ * free_transport - used to stop service processes and
+ * free allocated memory for transport struct.
+ * @transport - pointer to an object of transport struct
+ */
+void free_transport(struct transport* transport) {
+  for (int i = 0; i < transport->processes; i++) {
+    if (transport->pids[i] > 0) {
+      kill(transport->pids[i], SIGTERM);
+      waitpid(transport->pids[i], NULL, 0);
+    }
+  }
+
+  munmap(transport->memory, transport->size);
+  close(transport->memfd);
+  close(transport->efd);
+  free(transport->pids);
+  free(transport);
+}
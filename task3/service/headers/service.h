@@ -4,7 +4,25 @@
 #include "../../common/headers/common.h"
 #include "../../common/headers/endpoint.h"
 #include "../../server/headers/client.h"
+#include "../../server/headers/conntable.h"
+#include "../../server/headers/transport.h"
 #include "../../common/headers/msgbuf.h"
+#include "../../common/headers/scheduler.h"
+#include "../../common/headers/clock.h"
+#include "../../common/headers/codel.h"
+#include "../../common/headers/cache.h"
+
+/**
+ * Used as load statistics of service, collected and
+ * reset by pool controller every interval.
+ */
+struct service_stats {
+  /* Histogram of queue wait, bucket i counts waits below 2^i us */
+  _Atomic uint64_t wait_hist[WAIT_BUCKETS];
+
+  /* Time spent processing requests (ns) */
+  _Atomic uint64_t busy_ns;
+};
 
 /**
  * Service for communication with client. Containts
@@ -16,29 +34,56 @@ struct service {
   /* Thread for service */
   pthread_t thread;
   
-  /* Mutex for msq */
-  pthread_mutex_t mutex;
+  /* Scheduler of requests from listener server */
+  struct scheduler* scheduler;
 
-  /* Id for message queue */
-  int msqid;
+  /* Table of connections of listener server */
+  struct conn_table* connections;
 
   /* Id for service */
   int id;
+
+  /* Index of worker in scheduler */
+  int worker;
+
+  /* Thread is running */
+  int running;
+
+  /* Mutex for starting and retiring thread */
+  pthread_mutex_t mutex;
+
+  /* CoDel state of service */
+  struct codel codel;
+
+  /* Cache of responses shared by services, NULL if disabled */
+  struct response_cache* cache;
+
+  /* Load statistics */
+  struct service_stats stats;
 };
 
-struct service* create_service(int msqid, pthread_mutex_t msq_mutex, int id);
+struct service* create_service(struct scheduler* scheduler, struct conn_table* connections, int id);
+
+void start_service(struct service* service);
+
+int retire_service(struct service* service);
 
 void* run_service(void* arg);
 
+void record_wait(struct service* service, uint64_t wait_ns);
+
 void handle_client_requests(struct service* service);
 
-void send_message(struct client* client, char buffer[BUFFER_SIZE]);
+void flush_replies(struct user_request* requests, struct client** clients, 
+                   char** replies, size_t amount);
 
-struct msg recv_request(struct service* service);
+size_t recv_requests(struct service* service, struct user_request* requests, size_t max);
 
 char* edit_message(char* message);
 
-void close_connection(struct client *client);
+void run_process_service(struct transport* transport, int id);
+
+void signal_listener(struct transport* transport);
 
 void free_service(struct service* service);
 #endif // !SERVICE_H
@@ -0,0 +1,97 @@
+#include "../headers/service.h"
+
+/*
+ * run_process_service - used as main loop of service
+ * running as separate process. Takes batch of requests
+ * from request ring, puts replies to reply ring and
+ * signals listener once per batch.
+ * @transport - pointer to an object of transport struct
+ * @id - id of service
+ */
+void run_process_service(struct transport* transport, int id) {
+  struct shm_slot* requests[MAX_BATCH];
+  size_t capacity = shm_slot_capacity(transport->replies);
+  struct codel codel;
+  uint64_t now;
+  size_t amount;
+  
+  /* Each process keeps own cache, memory is not shared */
+  struct response_cache* cache = RESPONSE_CACHE ? create_cache(CACHE_BUDGET) : NULL;
+  
+  init_codel(&codel);
+
+  /* Log start of service */
+  printf("%d : Service process %d started\n", id, getpid());
+
+  while (1) {
+    /* Wait for first request, then take what is queued */
+    amount = 0;
+    requests[amount++] = take_slot(transport->requests);
+    while (amount < MAX_BATCH && (requests[amount] = try_take_slot(transport->requests)) != NULL)
+      amount++;
+    
+    now = monotonic_ns();
+    for (size_t i = 0; i < amount; i++) {
+      struct shm_slot* request = requests[i];
+      struct shm_slot* reply;
+      
+      /* Wait for free reply slot, let listener drain replies */
+      while ((reply = reserve_slot(transport->replies)) == NULL) {
+        signal_listener(transport);
+        sched_yield();
+      }
+      
+      reply->handle = request->handle;
+      reply->seq = request->seq;
+      reply->timestamp = request->timestamp;
+      reply->dropped = 0;
+      
+      /* Client does not wait anymore, request only takes its turn */
+      if (request->deadline && now > request->deadline) {
+        printf("%d : Expired request dropped\n", id);
+        reply->dropped = 1;
+        reply->length = 0;
+      }
+      /* Shed load while queue delay stands */
+      else if (codel_should_drop(&codel, now - request->timestamp, now)) {
+        reply->length = snprintf(reply->data, capacity, "%s", OVERLOADED_REPLY);
+      }
+      else {
+        /* Log received message */
+        printf("%d : Client send message: %s\n", id, request->data);
+        
+        if (cache) {
+          /* Copy cached or freshly built reply to reply slot */
+          char* message = cached_reply(cache, request->data, edit_message);
+          reply->length = snprintf(reply->data, capacity, "%s", message);
+          free(message);
+        }
+        else {
+          /* Add prefix to message right in reply slot */
+          reply->length = snprintf(reply->data, capacity, "%s %s", "Server", request->data);
+        }
+        if (reply->length >= capacity)
+          reply->length = capacity - 1;
+      }
+      
+      publish_slot(transport->replies, reply);
+      release_slot(transport->requests, request);
+    }
+    
+    /* Wake listener once per batch */
+    signal_listener(transport);
+    fflush(stdout);
+  }
+}
+
+/*
+ * signal_listener - used to wake listener server to
+ * drain reply ring.
+ * @transport - pointer to an object of transport struct
+ */
+void signal_listener(struct transport* transport) {
+  uint64_t one = 1;
+
+  if (write(transport->efd, &one, sizeof(one)) == -1 && errno != EAGAIN)
+    print_error("write");
+}
@@ -2,26 +2,72 @@
 
 /*
  * create_service - used to create an object of service struct.
- * @msqid - id for msq for requests from listener server  
- * @msq_mutex - mutex to controll access to msq 
- * @id - id for msq messages (used to send messages)
+ * @scheduler - scheduler of requests from listener server  
+ * @connections - table of connections of listener server
+ * @worker - index of worker in scheduler
  *
  * Return: pointer to an object of service struct 
  */
-struct service* create_service(int msqid, pthread_mutex_t msq_mutex, int id) {
-  struct service* service = (struct service*) malloc(sizeof(struct service));
+struct service* create_service(struct scheduler* scheduler, struct conn_table* connections, int worker) {
+  struct service* service = (struct service*) calloc(1, sizeof(struct service));
   
   if (!service)
-    print_error("malloc");
+    print_error("calloc");
 
   /* Initialize struct */
-  service->msqid = msqid;
-  service->mutex = msq_mutex;
-  service->id = id;
+  service->scheduler = scheduler;
+  service->connections = connections;
+  service->worker = worker;
+  service->id = worker + 1;
+  service->running = 0;
+  init_codel(&service->codel);
+
+  if (pthread_mutex_init(&service->mutex, NULL) != 0)
+    print_error("pthread_mutex_init");
 
   return service;
 }
 
+/*
+ * start_service - used to start thread of service if it
+ * is not running. Worker should be already active.
+ * @service - pointer to an object of service struct
+ */
+void start_service(struct service* service) {
+  pthread_mutex_lock(&service->mutex);
+
+  if (!service->running) {
+    if (pthread_create(&service->thread, NULL, run_service, (void *) service) != 0)
+      print_error("pthread_create");
+    pthread_detach(service->thread);
+    service->running = 1;
+  }
+
+  pthread_mutex_unlock(&service->mutex);
+}
+
+/*
+ * retire_service - used to check if service should stop.
+ * Worker that became active again keeps running.
+ * @service - pointer to an object of service struct
+ *
+ * Return: 1 if thread should exit, 0 otherwise
+ */
+int retire_service(struct service* service) {
+  int retired;
+
+  pthread_mutex_lock(&service->mutex);
+  
+  retired = service->worker >= atomic_load(&service->scheduler->active);
+  if (retired)
+    service->running = 0;
+  init_codel(&service->codel);
+
+  pthread_mutex_unlock(&service->mutex);
+
+  return retired;
+}
+
 /*
  * run_service - used to log service start.
  * Calls handle_client_connection
@@ -37,83 +83,170 @@ void* run_service(void* arg) {
 
   /* Wait for client connections */
   handle_client_requests(service);
+  
+  /* Log stop of service */
+  printf("%d : Service retired\n",
+         service->id);
 
   return NULL;
 }
 
 /*
- * handle_client_connection - used to wait for requests
- * from listener server and processes them.
+ * record_wait - used to count time request spent in queue.
+ * @service - pointer to an object of service struct
+ * @wait_ns - time in queue (ns)
+ */
+void record_wait(struct service* service, uint64_t wait_ns) {
+  uint64_t wait_us = wait_ns / 1000;
+  int bucket = wait_us ? 64 - __builtin_clzll(wait_us) : 0;
+
+  if (bucket >= WAIT_BUCKETS)
+    bucket = WAIT_BUCKETS - 1;
+
+  atomic_fetch_add_explicit(&service->stats.wait_hist[bucket], 1, memory_order_relaxed);
+}
+
+/*
+ * handle_client_requests - used to wait for requests
+ * from listener server and processes them in batches.
+ * Requests of batch are processed back to back, then
+ * replies are flushed with one write per connection.
+ * Requests of closed connections and expired requests are
+ * dropped, CoDel answers "overloaded" to requests while
+ * queue delay stands above target. Returns when service is
+ * retired by pool controller.
  * @service - pointer to an object of service struct
  */
 void handle_client_requests(struct service* service) {
-  /* Accept connections */
+  struct user_request requests[MAX_BATCH];
+  struct client* clients[MAX_BATCH];
+  char* replies[MAX_BATCH];
+  uint64_t start;
+  size_t amount;
+  
   while (1) {
-    char* reply;
-    struct msg msg = recv_request(service);
+    amount = recv_requests(service, requests, MAX_BATCH);
+    
+    /* Nothing left for retired service */
+    if (amount == 0 && retire_service(service))
+      return;
+
+    start = monotonic_ns();
+    for (size_t i = 0; i < amount; i++) {
+      char* message = requests[i].payload->data + requests[i].offset;
+      uint64_t sojourn = start - requests[i].timestamp;
+      
+      record_wait(service, sojourn);
+      replies[i] = NULL;
+      
+      /* Find connection of request */
+      clients[i] = resolve_client(service->connections, requests[i].handle);
+      if (!clients[i]) {
+        printf("%d : Request of closed connection dropped\n", service->id);
+        continue;
+      }
+      
+      /* Client does not wait anymore, request only takes its turn */
+      if (requests[i].deadline && start > requests[i].deadline) {
+        printf("%d : Expired request of %s:%d dropped\n", 
+               service->id, clients[i]->endpoint->ip, clients[i]->endpoint->port);
+        continue;
+      }
+      
+      /* Shed load while queue delay stands */
+      if (codel_should_drop(&service->codel, sojourn, start)) {
+        replies[i] = strdup(OVERLOADED_REPLY);
+        if (!replies[i])
+          print_error("strdup");
+        continue;
+      }
      
-    /* Log received message */
-    printf("%d : Client %s:%d send message: %s\n", 
-           service->id, 
-           msg.payload.client.endpoint->ip, 
-           msg.payload.client.endpoint->port,
-           msg.payload.message);
+      /* Log received message */
+      printf("%d : Client %s:%d send message: %s\n", 
+             service->id, 
+             clients[i]->endpoint->ip, 
+             clients[i]->endpoint->port,
+             message);
     
-    /* Add prefix to message */
-    reply = edit_message(msg.payload.message);
+      /* Add prefix to message */
+      replies[i] = cached_reply(service->cache, message, edit_message);
+    }
     
-    /* Send reply */
-    send_message(&msg.payload.client, reply);
+    /* Send replies */
+    flush_replies(requests, clients, replies, amount);
     
-    /* Log reply */
-    printf("%d : Send response to %s:%d : %s\n", 
-           service->id, 
-           msg.payload.client.endpoint->ip, 
-           msg.payload.client.endpoint->port,
-           msg.payload.message);
-
-    free(reply);
+    /* Free batch, replies are owned by clients now */
+    for (size_t i = 0; i < amount; i++) {
+      release_payload(requests[i].payload);
+      if (clients[i])
+        release_client(clients[i]);
+    }
+    
+    atomic_fetch_add_explicit(&service->stats.busy_ns, monotonic_ns() - start, 
+                              memory_order_relaxed);
   }
 }
 
 /*
- * send_message - used to send message to client. First
- * sends length of the buffer, then sends the message.
- * @client - pointer to an object of client struct 
- * @buffer - message
+ * flush_replies - used to pass replies of batch to reorder
+ * buffers of their connections. Replies for the same
+ * connection are submitted together, so they are sent in one
+ * write when previous replies are already sent. NULL reply
+ * of dropped request only takes its turn. Takes ownership
+ * of replies.
+ * @requests - array of processed requests
+ * @clients - array of clients of requests, NULL if closed
+ * @replies - array of replies for requests
+ * @amount - amount of requests in batch
  */
-void send_message(struct client* client, char buffer[BUFFER_SIZE]) {
-  uint32_t message_len;
-  uint32_t net_len;
-  
-  message_len = strlen(buffer);
-  net_len = htonl(message_len);
+void flush_replies(struct user_request* requests, struct client** clients, 
+                   char** replies, size_t amount) {
+  int flushed[MAX_BATCH] = { 0 };
   
-  /* Send message length */
-  if (send(client->fd, &net_len, sizeof(net_len), 0) == -1)
-    print_error("send");
-  
-  /* Send new message */
-  if (send(client->fd, buffer, message_len, 0) == -1)
-    print_error("send");
+  for (size_t i = 0; i < amount; i++) {
+    struct client* client = clients[i];
+    struct reply* list = NULL;
+    struct reply** tail = &list;
+    
+    if (flushed[i] || !client)
+      continue;
+
+    /* Collect replies for connection */
+    for (size_t j = i; j < amount; j++) {
+      if (flushed[j] || clients[j] != client)
+        continue;
+      
+      struct reply* reply = (struct reply*) malloc(sizeof(struct reply));
+      if (!reply)
+        print_error("malloc");
+      
+      reply->seq = requests[j].seq;
+      reply->data = replies[j];
+      reply->length = replies[j] ? strlen(replies[j]) : 0;
+      reply->next = NULL;
+      *tail = reply;
+      tail = &reply->next;
+      flushed[j] = 1;
+    }
+    
+    /* Send replies in order of requests */
+    submit_replies(client, list);
+  }
 }
 
 /*
- * recv_request - used to receive request from 
- * listener server through message queue 
+ * recv_requests - used to receive batch of requests from 
+ * listener server. Takes own requests first, then steals
+ * from other services. Sleeps while there is nothing to do.
+ * Retired service gets nothing when its queue is empty.
  * @service - pointer to an object of service struct
+ * @requests - array to store requests
+ * @max - size of array
+ *
+ * Return: amount of received requests
  */
-struct msg recv_request(struct service* service) {
-  struct msg msg;
-  
-  pthread_mutex_lock(&service->mutex);
-  
-  if (msgrcv(service->msqid, &msg, sizeof(msg), 0, 0) == -1)
-    print_error("msgrcv");
-  
-  pthread_mutex_unlock(&service->mutex);
-  
-  return msg;
+size_t recv_requests(struct service* service, struct user_request* requests, size_t max) {
+  return take_work(service->scheduler, service->worker, requests, max);
 }
 
 /*
@@ -135,21 +268,14 @@ char* edit_message(char* message) {
   return new_message;
 }
 
-/*
- * close_connection - used to close connection when client
- * called shutdown. Closes clients file descriptor and
- * frees memory allocated for client; 
- */
-void close_connection(struct client *client) {
-  close(client->fd);
-}
-
 /*
  * free_service - used to free allocated memory
  * for service struct.
  * @service - pointer to an object of service struct
  */
 void free_service(struct service* service) {
-  pthread_cancel(service->thread);
+  if (service->running)
+    pthread_cancel(service->thread);
+  pthread_mutex_destroy(&service->mutex);
   free(service);
 }
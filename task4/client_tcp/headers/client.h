@@ -3,17 +3,22 @@
 
 #include "../../common/headers/common.h"
 #include "../../common/headers/endpoint.h"
+#include "../../common/headers/sockopt.h"
 
 /*
- * Used as client for connection to local address
- * family (AF_INET) server via TCP protocol. 
+ * Used as client for connection to inet address
+ * family (AF_INET) server via TCP protocol or to
+ * local (AF_UNIX) server via stream socket. 
  */
 struct client {
   /* Adress of the server */
-  struct sockaddr_in serv;
+  struct sockaddr_storage serv;
+
+  /* Length of server address */
+  socklen_t serv_len;
   
-  /* IP and port of server */
-  struct endpoint* serv_endpoint;
+  /* Address of server for logs */
+  char serv_name[ADDRESS_SIZE];
 
   /* Server file descriptor*/
   int sfd;
@@ -21,6 +26,8 @@ struct client {
 
 struct client* create_client(const char* ip, const int port);
 
+struct client* create_unix_client(const char* path);
+
 void run_client(struct client* client);
 
 void process_input(struct client* client);
@@ -9,21 +9,58 @@
  * Return: pointer to an object of client struct
  */
 struct client* create_client(const char* ip, const int port) {
-  struct client* client = (struct client*) malloc(sizeof(struct client));
+  struct client* client = (struct client*) calloc(1, sizeof(struct client));
+  struct sockaddr_in* serv;
   if (!client)
-    print_error("malloc");
+    print_error("calloc");
+
+  serv = (struct sockaddr_in*) &client->serv;
 
   /* Initialzie sockaddr_in struct*/
-  client->serv.sin_family = AF_INET;
-  client->serv.sin_addr.s_addr = inet_addr(ip);
-  client->serv.sin_port = htons(port);
-  client->serv_endpoint = atoe(&client->serv);
+  serv->sin_family = AF_INET;
+  serv->sin_addr.s_addr = inet_addr(ip);
+  serv->sin_port = htons(port);
+  client->serv_len = sizeof(*serv);
+  format_address((struct sockaddr*) serv, client->serv_len, client->serv_name, sizeof(client->serv_name));
 
   /* Open socket */
   client->sfd = socket(AF_INET, SOCK_STREAM, 0);
   if (client->sfd == -1)
     print_error("socket");
   
+  /* Send first request in SYN */
+  set_fastopen_connect(client->sfd);
+  
+  return client;
+}
+
+/*
+ * create_unix_client - used to create an object of client
+ * struct for server on the same host. AF_UNIX stream socket
+ * skips TCP/IP stack.
+ * @path - path of server socket
+ *
+ * Return: pointer to an object of client struct
+ */
+struct client* create_unix_client(const char* path) {
+  struct client* client = (struct client*) calloc(1, sizeof(struct client));
+  struct sockaddr_un* serv;
+  if (!client)
+    print_error("calloc");
+
+  serv = (struct sockaddr_un*) &client->serv;
+
+  /* Initialzie sockaddr_un struct*/
+  serv->sun_family = AF_UNIX;
+  strncpy(serv->sun_path, path, sizeof(serv->sun_path) - 1);
+  client->serv_len = sizeof(*serv);
+  snprintf(client->serv_name, sizeof(client->serv_name), "%s", path);
+
+  /* Open socket */
+  client->sfd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (client->sfd == -1)
+    print_error("socket");
+
   return client;
 }
 
@@ -32,16 +69,12 @@ struct client* create_client(const char* ip, const int port) {
  * @client - pointer to an object of client struct
  */
 void run_client(struct client* client) {
-  socklen_t serv_size = sizeof(client->serv);   
-  
   /* Connect to server */
-  if (connect(client->sfd, (struct sockaddr*) &client->serv, serv_size) == -1)
+  if (connect(client->sfd, (struct sockaddr*) &client->serv, client->serv_len) == -1)
     print_error("connect");
   
   /* Log connection */
-  printf("CLIENT: Connected to server %s:%d\n", 
-         client->serv_endpoint->ip, 
-         client->serv_endpoint->port);
+  printf("CLIENT: Connected to server %s\n", client->serv_name);
   
   /* Process user input */
   process_input(client);
@@ -75,33 +108,34 @@ void process_input(struct client* client) {
       break;
     }
     
-    printf("SERVER: Server %s:%d send response: %s\n", client->serv_endpoint->ip, client->serv_endpoint->port, message);
+    printf("SERVER: Server %s send response: %s\n", client->serv_name, message);
     free(message);
   }
 }
 
 /*
  * send_message - used to send message to server. Sends
- * buffer length first, converted to Big Endian, then sends
- * message itself.
+ * buffer length, converted to Big Endian, and message itself
+ * in one call, so whole frame fits in SYN with Fast Open.
  * @client - pointer to an object of client struct
  * @buffer - string that needs to be sent
  */
 void send_message(struct client* client, int fd, const char* buffer) {
   uint32_t buffer_len = strlen(buffer);
   uint32_t net_len = htonl(buffer_len);
+  struct iovec iov[2] = {
+    { .iov_base = &net_len, .iov_len = sizeof(net_len) },
+    { .iov_base = (void*) buffer, .iov_len = buffer_len },
+  };
+  struct msghdr msg = { .msg_iov = iov, .msg_iovlen = 2 };
   
-  /* Send message length */
-  if (send(fd, &net_len, sizeof(net_len), 0) == -1)
-    print_error("send");
+  /* Send message length and message */
+  if (sendmsg(fd, &msg, 0) == -1)
+    print_error("sendmsg");
   
   /* Log message len */
   printf("CLIENT: Send message len: %d\n", buffer_len);
   
-  /* Send message */
-  if (send(fd, buffer, buffer_len, 0) == -1)
-    print_error("send");
-  
   /* Log message*/
   printf("CLIENT: Send message: %s\n", buffer);
 }
@@ -183,6 +217,5 @@ void close_connection(struct client* client) {
  * @client - pointer to an object of client struct
  */
 void free_client(struct client* client) {
-  free(client->serv_endpoint);
   free(client);
 }
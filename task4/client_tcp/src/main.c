@@ -4,13 +4,31 @@ struct client* client;
 
 void cleanup();
 
-int main(void) {
-  client = create_client(SERVER_IP, SERVER_PORT);
+void usage(const char* name);
+
+int main(int argc, char** argv) {
+  int local = 0;
+  int opt;
+
+  /* Choose local socket instead of network */
+  while ((opt = getopt(argc, argv, "u")) != -1) {
+    if (opt == 'u')
+      local = 1;
+    else
+      usage(argv[0]);
+  }
+
+  client = local ? create_unix_client(UNIX_STREAM_PATH) : create_client(SERVER_IP, SERVER_PORT);
   atexit(cleanup);
   run_client(client);
   exit(EXIT_SUCCESS);
 }
 
+void usage(const char* name) {
+  fprintf(stderr, "Usage: %s [-u]\n", name);
+  exit(EXIT_FAILURE);
+}
+
 void cleanup() {
   shutdown_connection(client);
   close_connection(client);
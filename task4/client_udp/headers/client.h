@@ -2,14 +2,22 @@
 #define CLIENT_H
 
 #include "../../common/headers/common.h"
+#include "../../common/headers/endpoint.h"
 
 /*
  * Used as client for connection to inet address
- * family (AF_INET) server via UDP protocol. 
+ * family (AF_INET) server via UDP protocol or to
+ * local (AF_UNIX) server via datagram socket. 
  */
 struct client {
   /* Address of the server */
-  struct sockaddr_in serv;
+  struct sockaddr_storage serv;
+
+  /* Length of server address */
+  socklen_t serv_len;
+
+  /* Address of server for logs */
+  char serv_name[ADDRESS_SIZE];
   
   /* Server file descriptor*/
   int sfd;
@@ -17,11 +25,13 @@ struct client {
 
 struct client* create_client(const char* ip, const int port);
 
+struct client* create_unix_client(const char* path);
+
 void run_client(struct client* client);
 
 void process_input(struct client* client);
 
-void send_message(struct client* client, char buffer[BUFFER_SIZE]);
+void send_message(struct client* client, const char* buffer);
 
 char* recv_message(struct client* client);
 
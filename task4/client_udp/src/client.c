@@ -10,14 +10,19 @@
  * Return: pointer to an object of client struct
  */
 struct client* create_client(const char* ip, const int port) {
-  struct client* client = (struct client*) malloc(sizeof(struct client));
+  struct client* client = (struct client*) calloc(1, sizeof(struct client));
+  struct sockaddr_in* serv;
   if (!client)
-    print_error("malloc");
+    print_error("calloc");
 
-  /* Initialzie server sockaddr_un struct*/
-  client->serv.sin_family = AF_INET;
-  client->serv.sin_addr.s_addr = inet_addr(ip);
-  client->serv.sin_port = htons(port);
+  serv = (struct sockaddr_in*) &client->serv;
+
+  /* Initialzie server sockaddr_in struct*/
+  serv->sin_family = AF_INET;
+  serv->sin_addr.s_addr = inet_addr(ip);
+  serv->sin_port = htons(port);
+  client->serv_len = sizeof(*serv);
+  format_address((struct sockaddr*) serv, client->serv_len, client->serv_name, sizeof(client->serv_name));
 
   client->sfd = socket(AF_INET, SOCK_DGRAM, 0);
   if (client->sfd == -1)
@@ -26,14 +31,46 @@ struct client* create_client(const char* ip, const int port) {
   return client;
 }
 
+/*
+ * create_unix_client - used to create an object of client
+ * struct for server on the same host. Socket is bound to
+ * autogenerated abstract name, so server can reply to it.
+ * @path - path of server socket
+ *
+ * Return: pointer to an object of client struct
+ */
+struct client* create_unix_client(const char* path) {
+  struct client* client = (struct client*) calloc(1, sizeof(struct client));
+  struct sockaddr_un* serv;
+  sa_family_t family = AF_UNIX;
+  if (!client)
+    print_error("calloc");
+
+  serv = (struct sockaddr_un*) &client->serv;
+
+  /* Initialzie server sockaddr_un struct*/
+  serv->sun_family = AF_UNIX;
+  strncpy(serv->sun_path, path, sizeof(serv->sun_path) - 1);
+  client->serv_len = sizeof(*serv);
+  snprintf(client->serv_name, sizeof(client->serv_name), "%s", path);
+
+  client->sfd = socket(AF_UNIX, SOCK_DGRAM, 0);
+  if (client->sfd == -1)
+    print_error("socket");
+
+  /* Autobind: address of family only gets abstract name */
+  if (bind(client->sfd, (struct sockaddr*) &family, sizeof(family)) == -1)
+    print_error("bind");
+
+  return client;
+}
+
 /* run_client - used to connect serv address
  * to file descriptor client->sfd
  * @client - pointer to an object of client struct
  */
 void run_client(struct client* client) {
-  socklen_t server_len = sizeof(client->serv);   
-   
-  if (connect(client->sfd, (struct sockaddr*) &client->serv, server_len) == -1)
+  if (connect(client->sfd, (struct sockaddr*) &client->serv, client->serv_len) == -1)
     print_error("connect");
 
   /* Process user input */
@@ -47,7 +84,7 @@ void run_client(struct client* client) {
  * @client - pointer to an object of client struct
  */
 void process_input(struct client* client) {
-  char buffer[BUFFER_SIZE];
+  char buffer[UDP_MAX_PAYLOAD + 1];
   
   /* Wait for user input */
   while (1) {
@@ -68,9 +105,8 @@ void process_input(struct client* client) {
       break;
     }
 
-    printf("SERVER: Server %s:%d send response: %s\n", 
-           inet_ntoa(client->serv.sin_addr), 
-           ntohs(client->serv.sin_port), 
+    printf("SERVER: Server %s send response: %s\n", 
+           client->serv_name, 
            message);
     free(message);
   }
@@ -81,7 +117,7 @@ void process_input(struct client* client) {
  * @client - pointer to an object of client struct 
  * @buffer - message
  */
-void send_message(struct client* client, char buffer[BUFFER_SIZE]) {
+void send_message(struct client* client, const char* buffer) {
   ssize_t bytes_send;
   
   /* Send message to server */
@@ -90,29 +126,43 @@ void send_message(struct client* client, char buffer[BUFFER_SIZE]) {
   if (bytes_send == -1)
     print_error("sendto");
 
-  printf("CLIENT: Send message to %s:%d: %s\n", 
-         inet_ntoa(client->serv.sin_addr), 
-         ntohs(client->serv.sin_port), 
+  printf("CLIENT: Send message to %s: %s\n", 
+         client->serv_name, 
          buffer);
 }
 
 /*
  * recv_message - used to receive message from server.
- * Allocates memory for buffer which should be freed manually.
+ * Allocates memory for datagram of max size which should
+ * be freed manually. With MSG_TRUNC recv returns real
+ * length, so reply cut by buffer is detected.
  *
  * Return: string (message) if successful, NULL if connection terminated
  */
 char* recv_message(struct client* client) {
   ssize_t bytes_read;
-  char* buffer = (char*) malloc(BUFFER_SIZE * sizeof(char));
+  char* buffer = (char*) malloc(UDP_MAX_PAYLOAD + 1);
+  if (!buffer)
+    print_error("malloc");
   
   /* Receive message from server */ 
-  bytes_read = recv(client->sfd, buffer, BUFFER_SIZE, 0);
+  bytes_read = recv(client->sfd, buffer, UDP_MAX_PAYLOAD, MSG_TRUNC);
   
   if (bytes_read == -1)
     print_error("recvfrom");
-  else if (bytes_read == 0)
+  else if (bytes_read == 0) {
+    free(buffer);
     return NULL;
+  }
+
+  /* Reply did not fit in buffer */
+  if (bytes_read > UDP_MAX_PAYLOAD) {
+    printf("CLIENT: Response of %zd bytes truncated\n", bytes_read);
+    bytes_read = UDP_MAX_PAYLOAD;
+  }
+
+  /* Terminate message */
+  buffer[bytes_read] = '\0';
 
   return buffer;
 }
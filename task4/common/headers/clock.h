@@ -0,0 +1,11 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include "common.h"
+#include <time.h>
+
+uint64_t monotonic_ns(void);
+
+uint64_t monotonic_ms(void);
+
+#endif // !CLOCK_H
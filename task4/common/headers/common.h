@@ -1,6 +1,8 @@
 #ifndef COMMON_H
 #define COMMON_H
 
+#define _GNU_SOURCE
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <sys/types.h>
@@ -12,11 +14,53 @@
 #include <netinet/in.h>
 #include <string.h>
 
-#define CLIENTS_AMOUNT 5
+#define CLIENTS_AMOUNT SOMAXCONN
 #define BUFFER_SIZE 128
 #define SERVER_IP "127.0.0.1" 
 #define SERVER_PORT 7777
+#define UNIX_STREAM_PATH "/tmp/task4_stream.sock"
+#define UNIX_DGRAM_PATH "/tmp/task4_dgram.sock"
+#define ADDRESS_SIZE 128
 #define SERVICES_AMOUNT 5
+#ifndef FASTOPEN
+#define FASTOPEN 0
+#endif
+#define FASTOPEN_QUEUE 16
+#ifndef RESPONSE_CACHE
+#define RESPONSE_CACHE 0
+#endif
+#ifndef CACHE_BUDGET
+#define CACHE_BUDGET (16 * 1024 * 1024)
+#endif
+#define CACHE_SHARDS 16
+#define CACHE_SHARD_SLOTS 4096
+#define CACHE_STATS_PERIOD 10000
+#define LOOP_EVENTS 1024
+#define MAX_MESSAGE_SIZE (1 << 20)
+#define READ_BUDGET 16
+#define OUTPUT_LIMIT (256 * 1024)
+#define UDP_BATCH 32
+#define UDP_MAX_SEGMENTS 64
+#define UDP_MAX_PAYLOAD 65507
+#define UDP_GRO_BUFFER 65535
+#define POOL_CLASSES 5
+#define POOL_MIN_BUFFER 256
+#define POOL_CLASS_STEP 4
+#define REPLY_PREFIX "Server "
+#define FLOW_TABLE_SIZE 256
+#define FLOW_TABLE_MAX (1 << 16)
+#define FLOW_LOAD_PERCENT 70
+#define FLOW_TIMEOUT_MS 30000
+#define FLOW_SWEEP_MS 1000
+#define FLOW_RATE_WINDOW_MS 1000
+#define IDLE_TIMEOUT_MS 60000
+#define STATS_INTERVAL_MS 10000
+#define MAX_WORKERS 64
+#define MAX_BUSY_POLL_US 10000
+#define SPIN_GAP_WEIGHT 8
+#ifndef UDP_OFFLOAD
+#define UDP_OFFLOAD 0
+#endif
 #define print_error(msg) do {perror(msg); \
   exit(EXIT_FAILURE);} while(0)
 
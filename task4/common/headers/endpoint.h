@@ -2,6 +2,8 @@
 #define ENDPOINT_H
 
 #include "common.h"
+#include <sys/un.h>
+#include <stddef.h>
 
 /**
  * Used as data struct containing ip address and port
@@ -19,5 +21,7 @@ struct endpoint* stoe(char* buffer);
 
 void free_endpoint(struct endpoint* endpoint);
 
+void format_address(struct sockaddr* addr, socklen_t len, char* buffer, size_t size);
+
 #endif // !ENDPOINT_H
 
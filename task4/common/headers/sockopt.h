@@ -0,0 +1,17 @@
+#ifndef SOCKOPT_H
+#define SOCKOPT_H
+
+#include "common.h"
+#include <netinet/tcp.h>
+#include <netinet/udp.h>
+#include <errno.h>
+
+void set_fastopen(int fd);
+
+void set_fastopen_connect(int fd);
+
+void set_udp_offload(int fd);
+
+void set_busy_poll(int fd, int usec);
+
+#endif // !SOCKOPT_H
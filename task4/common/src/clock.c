@@ -0,0 +1,24 @@
+#include "../headers/clock.h"
+
+/*
+ * monotonic_ns - used to get current time of monotonic
+ * clock, used for request timestamps.
+ *
+ * Return: time in nanoseconds
+ */
+uint64_t monotonic_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/*
+ * monotonic_ms - used to get current time of monotonic
+ * clock, used for timers of event loop.
+ *
+ * Return: time in milliseconds
+ */
+uint64_t monotonic_ms(void) {
+  return monotonic_ns() / 1000000ull;
+}
@@ -46,3 +46,34 @@ struct endpoint* stoe(char* buffer) {
 void free_endpoint(struct endpoint* endpoint) {
   free(endpoint);
 }
+
+/*
+ * format_address - used to print address of any family for
+ * logs: "ip:port" for AF_INET, path for AF_UNIX ("@name" for
+ * abstract one) and "unix" for unnamed socket.
+ * @addr - pointer to address
+ * @len - length of address
+ * @buffer - buffer for string
+ * @size - size of buffer
+ */
+void format_address(struct sockaddr* addr, socklen_t len, char* buffer, size_t size) {
+  if (addr->sa_family == AF_INET) {
+    struct sockaddr_in* in = (struct sockaddr_in*) addr;
+    char ip[INET_ADDRSTRLEN];
+
+    inet_ntop(AF_INET, &in->sin_addr, ip, sizeof(ip));
+    snprintf(buffer, size, "%s:%d", ip, ntohs(in->sin_port));
+  }
+  else if (addr->sa_family == AF_UNIX && len > offsetof(struct sockaddr_un, sun_path)) {
+    struct sockaddr_un* un = (struct sockaddr_un*) addr;
+    int path_len = len - offsetof(struct sockaddr_un, sun_path);
+
+    /* Abstract name starts with zero byte and is not terminated */
+    if (un->sun_path[0] == '\0')
+      snprintf(buffer, size, "@%.*s", path_len - 1, un->sun_path + 1);
+    else
+      snprintf(buffer, size, "%.*s", path_len, un->sun_path);
+  }
+  else
+    snprintf(buffer, size, "unix");
+}
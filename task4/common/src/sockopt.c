@@ -0,0 +1,76 @@
+#include "../headers/sockopt.h"
+
+/*
+ * set_fastopen - used to enable TCP Fast Open on listening
+ * socket, so data of the first request can arrive in SYN.
+ * Does nothing if project is built without FASTOPEN.
+ * Must be called before listen.
+ * @fd - file descriptor of listening socket
+ */
+void set_fastopen(int fd) {
+  int qlen = FASTOPEN_QUEUE;
+
+  if (!FASTOPEN)
+    return;
+
+  if (setsockopt(fd, IPPROTO_TCP, TCP_FASTOPEN, &qlen, sizeof(qlen)) == -1)
+    print_error("setsockopt");
+}
+
+/*
+ * set_fastopen_connect - used to enable TCP Fast Open on
+ * client socket. Connect is deferred until the first send,
+ * which carries the request in SYN when server cookie is
+ * known. Does nothing if project is built without FASTOPEN.
+ * Must be called before connect.
+ * @fd - file descriptor of client socket
+ */
+void set_fastopen_connect(int fd) {
+  int enable = 1;
+
+  if (!FASTOPEN)
+    return;
+
+  if (setsockopt(fd, IPPROTO_TCP, TCP_FASTOPEN_CONNECT, &enable, sizeof(enable)) == -1)
+    print_error("setsockopt");
+}
+
+/*
+ * set_udp_offload - used to enable UDP GRO on socket, so
+ * kernel may pass several datagrams of one flow as one
+ * coalesced datagram. GSO is requested per send with
+ * UDP_SEGMENT. Does nothing if project is built without
+ * UDP_OFFLOAD.
+ * @fd - file descriptor of UDP socket
+ */
+void set_udp_offload(int fd) {
+  int enable = 1;
+
+  if (!UDP_OFFLOAD)
+    return;
+
+  if (setsockopt(fd, SOL_UDP, UDP_GRO, &enable, sizeof(enable)) == -1)
+    print_error("setsockopt");
+}
+
+/*
+ * set_busy_poll - used to let blocking reads of socket poll
+ * device queue for up to usec instead of sleeping, and to
+ * prefer busy polling over interrupts. Raising SO_BUSY_POLL
+ * above net.core.busy_read needs CAP_NET_ADMIN, so EPERM
+ * is ignored. Does nothing if usec is 0.
+ * @fd - file descriptor of socket
+ * @usec - time of busy polling in microseconds
+ */
+void set_busy_poll(int fd, int usec) {
+  int enable = 1;
+
+  if (!usec)
+    return;
+
+  if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &usec, sizeof(usec)) == -1 && errno != EPERM)
+    print_error("setsockopt");
+
+  if (setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &enable, sizeof(enable)) == -1 && errno != EPERM)
+    print_error("setsockopt");
+}
@@ -2,20 +2,76 @@
 #define CLIENT_H
 
 #include "../../common/headers/common.h"
+#include "../../common/headers/endpoint.h"
+#include "timer.h"
+#include <errno.h>
 
 /**
  * Used as data struct to specify clients
- * address, descriptor for communication 
+ * address, descriptor for communication and
+ * state of connection: message being received
+ * and replies waiting to be sent.
  */
 struct client {
-  /* Clients address */
-  struct sockaddr_in* addr;
+  /* Clients address, AF_INET or AF_UNIX */
+  struct sockaddr_storage addr;
+
+  /* Worker that serves client */
+  struct worker* worker;
+
+  /* Address of client for logs */
+  char name[ADDRESS_SIZE];
+
+  /* Message being received, NULL while length is received */
+  char* message;
+
+  /* Framed replies waiting to be sent */
+  char* output;
+
+  /* Bytes of replies in output */
+  size_t output_len;
+
+  /* Bytes of replies already sent */
+  size_t output_sent;
+
+  /* Size of output buffer */
+  size_t output_size;
+
+  /* Closes connection of idle client */
+  struct timer idle_timer;
+
+  /* Time of last message in ms */
+  uint64_t last_active;
+
+  /* Message length in network form */
+  uint32_t net_len;
+
+  /* Bytes of length received */
+  uint32_t header_received;
+
+  /* Length of message being received */
+  uint32_t message_len;
+
+  /* Bytes of message received */
+  uint32_t message_received;
+
+  /* Events watched in event loop */
+  uint32_t interest;
 
-  /* IP and port */
-  struct endpoint* endpoint;
-  
   /* File descriptor for communication */
   int fd;
 };
 
+struct client* create_client(struct sockaddr* addr, socklen_t len, int fd);
+
+int recv_message(struct client* client, char** message);
+
+void queue_reply(struct client* client, const char* reply);
+
+int flush_replies(struct client* client);
+
+size_t pending_output(struct client* client);
+
+void free_client(struct client* client);
+
 #endif // !CLIENT_H
@@ -0,0 +1,76 @@
+#ifndef FLOW_H
+#define FLOW_H
+
+#include "../../common/headers/common.h"
+#include "../../common/headers/endpoint.h"
+#include "../../common/headers/cache.h"
+
+/**
+ * Used as state of one datagram peer. Flow lives in
+ * slot of table and may move on rehash or removal of
+ * neighbour, so pointer to it is valid only until next
+ * change of table.
+ */
+struct flow {
+  /* Hash of peer address, 0 if slot is empty */
+  uint64_t hash;
+
+  /* Time of last datagram in ms */
+  uint64_t last_seen;
+
+  /* Sequence number of last datagram of peer */
+  uint64_t seq;
+
+  /* Bytes received from peer */
+  uint64_t bytes;
+
+  /* Start of current rate window in ms */
+  uint64_t window_start;
+
+  /* Datagrams in current rate window */
+  uint32_t window_datagrams;
+
+  /* Datagrams in last complete rate window */
+  uint32_t rate;
+
+  /* Length of address */
+  socklen_t addr_len;
+
+  /* Address of peer */
+  struct sockaddr_storage addr;
+
+  /* Address of peer for logs */
+  char name[ADDRESS_SIZE];
+};
+
+/**
+ * Used as hash table of flows keyed by peer address
+ * with open addressing and linear probing. Removed flow
+ * is replaced by shifting following ones back, so there
+ * are no tombstones and lookup stops at first empty slot.
+ * Table belongs to one worker and has no lock.
+ */
+struct flow_table {
+  /* Slots, capacity long */
+  struct flow* flows;
+
+  /* Amount of slots, power of two */
+  size_t capacity;
+
+  /* Amount of flows */
+  size_t amount;
+};
+
+struct flow_table* create_flow_table(size_t capacity);
+
+uint64_t hash_address(struct sockaddr* addr, socklen_t len);
+
+struct flow* find_flow(struct flow_table* table, struct sockaddr* addr, socklen_t len, uint64_t now);
+
+void update_flow(struct flow* flow, uint32_t datagrams, size_t bytes, uint64_t now);
+
+int expire_flows(struct flow_table* table, uint64_t now);
+
+void free_flow_table(struct flow_table* table);
+
+#endif // !FLOW_H
@@ -0,0 +1,109 @@
+#ifndef LOOP_H
+#define LOOP_H
+
+#include "../../common/headers/common.h"
+#include <errno.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/select.h>
+
+/* Interest and readiness flags of event loop */
+#define LOOP_READ 0x1
+#define LOOP_WRITE 0x2
+#define LOOP_ERROR 0x4
+#define LOOP_EXCLUSIVE 0x8
+#define LOOP_EDGE 0x10
+#define LOOP_ONESHOT 0x20
+
+enum loop_backend { LOOP_SELECT = 0, LOOP_POLL = 1, LOOP_EPOLL = 2 };
+
+/**
+ * Used as ready event returned by event loop.
+ */
+struct loop_event {
+  /* Ready file descriptor */
+  int fd;
+
+  /* LOOP_READ, LOOP_WRITE and LOOP_ERROR flags */
+  uint32_t events;
+
+  /* Data registered with file descriptor */
+  void* data;
+};
+
+/**
+ * Used as table of operations of multiplexer
+ * backend. Every backend keeps own state and
+ * translates LOOP_* flags to its own. Only epoll
+ * supports LOOP_EXCLUSIVE, LOOP_EDGE and LOOP_ONESHOT,
+ * others ignore them.
+ */
+struct loop_ops {
+  /* Name of backend */
+  const char* name;
+
+  /* Create state of backend */
+  void* (*create)(void);
+
+  /* Start watching fd */
+  int (*add)(void* state, int fd, uint32_t events);
+
+  /* Change interest of watched fd */
+  int (*modify)(void* state, int fd, uint32_t events);
+
+  /* Stop watching fd */
+  int (*remove)(void* state, int fd);
+
+  /* Wait for events, timeout in ms or -1 */
+  int (*wait)(void* state, struct loop_event* events, int max_events, int timeout);
+
+  /* Free state of backend */
+  void (*destroy)(void* state);
+};
+
+/**
+ * Used as event loop over one of multiplexer
+ * backends. Data of watched fds is kept here,
+ * so backends report only fds and flags.
+ */
+struct event_loop {
+  /* Operations of backend */
+  const struct loop_ops* ops;
+
+  /* State of backend */
+  void* state;
+
+  /* Data of watched fds, indexed by fd */
+  void** data;
+
+  /* Size of data table */
+  int capacity;
+
+  /* Events returned by last wait */
+  struct loop_event* events;
+
+  /* Size of events array */
+  int max_events;
+};
+
+extern const struct loop_ops select_ops;
+
+extern const struct loop_ops poll_ops;
+
+extern const struct loop_ops epoll_ops;
+
+struct event_loop* create_loop(enum loop_backend backend, int max_events);
+
+int parse_backend(const char* name, enum loop_backend* backend);
+
+int loop_register(struct event_loop* loop, int fd, uint32_t events, void* data);
+
+void loop_modify(struct event_loop* loop, int fd, uint32_t events);
+
+void loop_unregister(struct event_loop* loop, int fd);
+
+int loop_wait(struct event_loop* loop, int timeout);
+
+void free_loop(struct event_loop* loop);
+
+#endif // !LOOP_H
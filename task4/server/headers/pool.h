@@ -0,0 +1,44 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include "../../common/headers/common.h"
+
+/**
+ * Used as header of pooled buffer. Data of buffer
+ * follows header, free buffers are linked through it.
+ */
+struct pool_buffer {
+  /* Next free buffer of same class */
+  struct pool_buffer* next;
+
+  /* Size class of buffer */
+  int size_class;
+};
+
+/**
+ * Used as pool of buffers split in size classes, each
+ * class is POOL_CLASS_STEP times bigger than previous.
+ * Buffers are preallocated and returned to pool after
+ * use, class that runs out grows by one buffer, so pool
+ * reaches peak usage and then serves without malloc.
+ * Pool belongs to one worker and has no lock.
+ */
+struct buffer_pool {
+  /* Free buffers of every class */
+  struct pool_buffer* free[POOL_CLASSES];
+
+  /* Amount of buffers of every class */
+  int allocated[POOL_CLASSES];
+};
+
+struct buffer_pool* create_buffer_pool(int amount);
+
+size_t class_size(int size_class);
+
+char* pool_get(struct buffer_pool* pool, size_t size);
+
+void pool_put(struct buffer_pool* pool, char* buffer);
+
+void free_buffer_pool(struct buffer_pool* pool);
+
+#endif // !POOL_H
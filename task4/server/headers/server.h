@@ -3,20 +3,39 @@
 
 #include "../../common/headers/common.h"
 #include "../../common/headers/endpoint.h"
+#include "../../common/headers/sockopt.h"
+#include "../../common/headers/cache.h"
 #include "client.h"
-#include <poll.h>
-#include <sys/epoll.h>
-#include <sys/select.h>
+#include "loop.h"
+#include "worker.h"
 
-#define run_monitor(server) do { if (STANDARD == 0) \
-  {run_select(server);} \
-  else if (STANDARD == 1) \
-  {run_poll(server);} \
-  else {run_epoll(server);}} while(0)
+/**
+ * Used as options of server chosen at startup.
+ */
+struct server_config {
+  /* Multiplexer used by event loops */
+  enum loop_backend backend;
+
+  /* Amount of event loops */
+  int workers;
+
+  /* Workers share sockets watched with EPOLLEXCLUSIVE */
+  int exclusive;
+
+  /* Fds are watched edge-triggered and drained until EAGAIN */
+  int edge;
+
+  /* Client fds are disabled after event until rearmed */
+  int oneshot;
+
+  /* Max time of spinning before blocking wait in us, 0 to block */
+  int busy_poll;
+};
 
 /**
  * Used to create server on TCP and UDP protocol.
- * Using AF_INET address family.
+ * Using AF_INET address family. Requests are served
+ * by workers, each running own event loop.
  */
 struct server {
   /* Address of the server */
@@ -24,39 +43,42 @@ struct server {
   
   /* Endpoint of server */
   struct endpoint* endpoint;
+
+  /* Cache of responses, NULL if disabled */
+  struct response_cache* cache;
+
+  /* Options chosen at startup */
+  struct server_config config;
+
+  /* Workers running event loops */
+  struct worker** workers;
     
-  /* Fd for tcp socket */
+  /* Fd for shared tcp socket, -1 if workers own sockets */
   int tcp_fd;
   
-  /* Fd for udp socket */
+  /* Fd for shared udp socket, -1 if workers own sockets */
   int udp_fd;
-};
-
-struct server* create_server(const char* ip, const int port);
-
-void run_server(struct server* server);
 
-void run_select(struct server* server);
+  /* Fd for AF_UNIX stream socket shared by workers */
+  int unix_stream_fd;
 
-void run_poll(struct server* server);
-
-void run_epoll(struct server* server);
+  /* Fd for AF_UNIX datagram socket shared by workers */
+  int unix_dgram_fd;
+};
 
-void communicate_tcp(struct server* server);
+struct server* create_server(const char* ip, const int port, struct server_config* config);
 
-void communicate_udp(struct server* server);
+int open_socket(int type, int reuseport);
 
-void send_tcp(struct client* client, char buffer[BUFFER_SIZE]);
+void bind_sockets(struct server* server, int tcp_fd, int udp_fd);
 
-char* recv_tcp(struct client* client);
+int open_unix_socket(int type, const char* path);
 
-void send_udp(struct server* server, struct sockaddr_in* client, char buffer[BUFFER_SIZE]);
-  
-char* recv_udp(struct server* server, struct sockaddr_in* client);
+void run_server(struct server* server);
 
 char* edit_message(char* message);
 
-void close_connection(struct client* client);
+void format_reply(const char* message, char* buffer, size_t size);
 
 void free_server(struct server* server);
 
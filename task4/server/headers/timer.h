@@ -0,0 +1,60 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include "../../common/headers/common.h"
+#include "../../common/headers/clock.h"
+
+struct timer;
+
+typedef void (*timer_callback)(struct timer* timer, void* data);
+
+/**
+ * Used as timer embedded into object it belongs
+ * to. Timer knows its position in heap, so it is
+ * cancelled or moved without search.
+ */
+struct timer {
+  /* Time of expiration in ms of monotonic clock */
+  uint64_t expires;
+
+  /* Called when timer expires */
+  timer_callback callback;
+
+  /* Argument of callback */
+  void* data;
+
+  /* Position in heap, -1 if not scheduled */
+  int index;
+};
+
+/**
+ * Used as binary min-heap of timers ordered by
+ * expiration time. Nearest timer gives timeout
+ * of event loop wait.
+ */
+struct timer_queue {
+  /* Heap of scheduled timers */
+  struct timer** heap;
+
+  /* Amount of scheduled timers */
+  int amount;
+
+  /* Size of heap */
+  int size;
+};
+
+struct timer_queue* create_timer_queue(void);
+
+void init_timer(struct timer* timer, timer_callback callback, void* data);
+
+void schedule_timer(struct timer_queue* queue, struct timer* timer, uint64_t expires);
+
+void cancel_timer(struct timer_queue* queue, struct timer* timer);
+
+int next_timeout(struct timer_queue* queue, uint64_t now);
+
+void run_timers(struct timer_queue* queue, uint64_t now);
+
+void free_timer_queue(struct timer_queue* queue);
+
+#endif // !TIMER_H
@@ -0,0 +1,84 @@
+#ifndef UDP_H
+#define UDP_H
+
+#include "../../common/headers/common.h"
+#include "pool.h"
+#include <errno.h>
+#include <netinet/udp.h>
+#include <sys/uio.h>
+
+/* Size of control buffer for UDP_GRO and UDP_SEGMENT */
+#define UDP_CONTROL_SIZE CMSG_SPACE(sizeof(int))
+
+/**
+ * Used as preallocated batch of datagrams for
+ * recvmmsg and replies for sendmmsg. Receive buffer
+ * holds datagram of max size, replies are taken from
+ * pool. With offload received datagram may hold several
+ * coalesced segments and replies of one datagram may be
+ * sent as one GSO super datagram.
+ */
+struct udp_batch {
+  /* Headers for recvmmsg */
+  struct mmsghdr* recv_msgs;
+
+  /* Vectors pointing to receive buffers */
+  struct iovec* recv_iovs;
+
+  /* Addresses of senders, AF_INET or AF_UNIX */
+  struct sockaddr_storage* addrs;
+
+  /* Receive buffers, one byte more for terminator */
+  char* buffers;
+
+  /* Control buffers for UDP_GRO */
+  char* recv_controls;
+
+  /* Size of one receive buffer */
+  size_t buffer_size;
+
+  /* Headers for sendmmsg */
+  struct mmsghdr* send_msgs;
+
+  /* Vectors pointing to replies */
+  struct iovec* send_iovs;
+
+  /* Control buffers for UDP_SEGMENT */
+  char* send_controls;
+
+  /* Replies waiting for sendmmsg */
+  char** replies;
+
+  /* Pool replies are taken from */
+  struct buffer_pool* pool;
+
+  /* Amount of headers for sendmmsg */
+  int send_amount;
+
+  /* Amount of replies waiting */
+  int reply_amount;
+
+  /* Max amount of replies in batch */
+  int capacity;
+
+  /* GRO and GSO are enabled */
+  int offload;
+};
+
+struct udp_batch* create_udp_batch(int offload, struct buffer_pool* pool);
+
+int recv_batch(int fd, struct udp_batch* batch);
+
+char* batch_buffer(struct udp_batch* batch, int index);
+
+size_t segment_size(struct udp_batch* batch, int index);
+
+void add_reply(struct udp_batch* batch, char* reply);
+
+void queue_replies(struct udp_batch* batch, struct sockaddr* addr, socklen_t len, int first);
+
+void flush_batch(int fd, struct udp_batch* batch);
+
+void free_udp_batch(struct udp_batch* batch);
+
+#endif // !UDP_H
@@ -0,0 +1,132 @@
+#ifndef WORKER_H
+#define WORKER_H
+
+#include "../../common/headers/common.h"
+#include "client.h"
+#include "loop.h"
+#include "udp.h"
+#include "flow.h"
+#include "timer.h"
+#include <sched.h>
+
+struct server;
+
+/**
+ * Used as event loop running in own thread pinned
+ * to CPU. Worker owns its loop, timers, UDP buffers
+ * and accepted clients, so workers share no mutable
+ * state except optional cache of responses.
+ */
+struct worker {
+  /* Server worker belongs to */
+  struct server* server;
+
+  /* Event loop over chosen multiplexer */
+  struct event_loop* loop;
+
+  /* Buffers for UDP replies */
+  struct buffer_pool* pool;
+
+  /* Preallocated batch for UDP requests */
+  struct udp_batch* udp_batch;
+
+  /* Preallocated batch for AF_UNIX datagram requests */
+  struct udp_batch* unix_batch;
+
+  /* State of UDP and AF_UNIX datagram peers */
+  struct flow_table* flows;
+
+  /* Timers that limit wait of event loop */
+  struct timer_queue* timers;
+
+  /* Removes flows of silent peers every FLOW_SWEEP_MS */
+  struct timer flow_timer;
+
+  /* Prints statistics every STATS_INTERVAL_MS */
+  struct timer stats_timer;
+
+  /* Time after last wait in ms */
+  uint64_t now;
+
+  /* Time of last ready events in ns */
+  uint64_t last_arrival;
+
+  /* Average time between ready events in ns */
+  uint64_t arrival_gap;
+
+  /* Waits ended by events found while spinning */
+  uint64_t spin_wakeups;
+
+  /* Waits ended by blocking wait */
+  uint64_t block_wakeups;
+
+  /* TCP messages served since last statistics */
+  uint64_t tcp_messages;
+
+  /* UDP datagrams served since last statistics */
+  uint64_t udp_messages;
+
+  /* Flows expired since last statistics */
+  uint64_t expired_flows;
+
+  /* Amount of connected TCP clients */
+  int clients;
+
+  /* Fd for tcp socket, own or shared */
+  int tcp_fd;
+
+  /* Fd for udp socket, own or shared */
+  int udp_fd;
+
+  /* Fd for AF_UNIX stream socket, shared */
+  int unix_stream_fd;
+
+  /* Fd for AF_UNIX datagram socket, shared */
+  int unix_dgram_fd;
+
+  /* Id of worker, also its CPU */
+  int id;
+
+  /* Thread of worker */
+  pthread_t thread;
+};
+
+struct worker* create_worker(struct server* server, int id);
+
+void start_worker(struct worker* worker);
+
+void* run_worker(void* arg);
+
+void run_loop(struct worker* worker);
+
+uint64_t spin_budget(struct worker* worker);
+
+int wait_events(struct worker* worker, int timeout);
+
+void accept_clients(struct worker* worker, int fd);
+
+uint32_t loop_mode(struct worker* worker);
+
+int read_messages(struct worker* worker, struct client* client, int budget);
+
+void communicate_tcp(struct worker* worker, struct client* client, uint32_t events);
+
+void update_interest(struct worker* worker, struct client* client);
+
+void delete_client(struct worker* worker, struct client* client);
+
+void expire_client(struct timer* timer, void* data);
+
+void flush_stats(struct timer* timer, void* data);
+
+void sweep_flows(struct timer* timer, void* data);
+
+void communicate_udp(struct worker* worker, int fd, struct udp_batch* batch);
+
+char* pooled_reply(struct worker* worker, char* message, size_t message_len);
+
+void answer_batch(struct worker* worker, int fd, struct udp_batch* batch, int amount);
+
+void free_worker(struct worker* worker);
+
+#endif // !WORKER_H
@@ -0,0 +1,189 @@
+#include "../headers/client.h"
+
+/*
+ * create_client - used to create an object of client struct
+ * for accepted connection. Local client of AF_UNIX socket is
+ * usually unnamed, so it is named by pid of its process.
+ * @addr - pointer to address of the client
+ * @len - length of address
+ * @fd - file descriptor for communication
+ *
+ * Return: pointer to an object of client struct
+ */
+struct client* create_client(struct sockaddr* addr, socklen_t len, int fd) {
+  struct client* client = (struct client*) calloc(1, sizeof(struct client));
+  struct ucred cred;
+  socklen_t cred_len = sizeof(cred);
+
+  if (!client)
+    print_error("calloc");
+
+  memcpy(&client->addr, addr, len);
+  format_address(addr, len, client->name, sizeof(client->name));
+  client->fd = fd;
+
+  /* Name local client by its process */
+  if (addr->sa_family == AF_UNIX && len <= offsetof(struct sockaddr_un, sun_path) &&
+      getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &cred_len) == 0)
+    snprintf(client->name, sizeof(client->name), "unix:pid %d", cred.pid);
+
+  return client;
+}
+
+/*
+ * recv_message - used to receive message from non-blocking
+ * client socket. Receives message length first, then allocates
+ * memory for message and receives it. Partial message is kept
+ * in client struct until rest of it arrives. Returned message
+ * should be freed manually.
+ * @client - pointer to an object of client struct
+ * @message - pointer to store received message
+ *
+ * Return: 1 if message received, 0 if more data is needed,
+ * -1 if connection closed or message is too big
+ */
+int recv_message(struct client* client, char** message) {
+  ssize_t bytes_read;
+
+  /* Receive message length */
+  while (client->message == NULL) {
+    bytes_read = recv(client->fd, (char*) &client->net_len + client->header_received,
+                      sizeof(client->net_len) - client->header_received, 0);
+    if (bytes_read == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      return 0;
+    else if (bytes_read == -1 && errno == EINTR)
+      continue;
+    else if (bytes_read <= 0)
+      return -1;
+
+    client->header_received += bytes_read;
+    if (client->header_received < sizeof(client->net_len))
+      continue;
+
+    /* Convert message length to Little Endian */
+    client->message_len = ntohl(client->net_len);
+    if (client->message_len > MAX_MESSAGE_SIZE)
+      return -1;
+
+    /* Allocate memory for message */
+    client->message = (char*) malloc(client->message_len + 1);
+    if (!client->message)
+      print_error("malloc");
+    client->message_received = 0;
+  }
+
+  /* Receive rest of message */
+  while (client->message_received < client->message_len) {
+    bytes_read = recv(client->fd, client->message + client->message_received,
+                      client->message_len - client->message_received, 0);
+    if (bytes_read == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      return 0;
+    else if (bytes_read == -1 && errno == EINTR)
+      continue;
+    else if (bytes_read <= 0)
+      return -1;
+
+    client->message_received += bytes_read;
+  }
+
+  /* Terminate message and reset state for next one */
+  client->message[client->message_len] = '\0';
+  *message = client->message;
+  client->message = NULL;
+  client->header_received = 0;
+
+  return 1;
+}
+
+/*
+ * queue_reply - used to append reply framed with its
+ * length to output buffer of client.
+ * @client - pointer to an object of client struct
+ * @reply - reply message
+ */
+void queue_reply(struct client* client, const char* reply) {
+  uint32_t message_len = strlen(reply);
+  uint32_t net_len = htonl(message_len);
+  size_t needed;
+
+  /* Move unsent bytes to start of buffer */
+  if (client->output_sent > 0) {
+    memmove(client->output, client->output + client->output_sent,
+            client->output_len - client->output_sent);
+    client->output_len -= client->output_sent;
+    client->output_sent = 0;
+  }
+
+  /* Grow output buffer */
+  needed = client->output_len + sizeof(net_len) + message_len;
+  if (needed > client->output_size) {
+    size_t size = client->output_size ? client->output_size : BUFFER_SIZE;
+    char* output;
+
+    while (size < needed)
+      size *= 2;
+
+    output = (char*) realloc(client->output, size);
+    if (!output)
+      print_error("realloc");
+
+    client->output = output;
+    client->output_size = size;
+  }
+
+  memcpy(client->output + client->output_len, &net_len, sizeof(net_len));
+  memcpy(client->output + client->output_len + sizeof(net_len), reply, message_len);
+  client->output_len = needed;
+}
+
+/*
+ * flush_replies - used to send as much of output buffer
+ * as socket accepts without blocking.
+ * @client - pointer to an object of client struct
+ *
+ * Return: 0 if everything is sent, 1 if socket is full,
+ * -1 if connection is broken
+ */
+int flush_replies(struct client* client) {
+  while (client->output_sent < client->output_len) {
+    ssize_t bytes_send = send(client->fd, client->output + client->output_sent,
+                              client->output_len - client->output_sent, MSG_NOSIGNAL);
+    if (bytes_send == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      return 1;
+    else if (bytes_send == -1 && errno == EINTR)
+      continue;
+    else if (bytes_send == -1)
+      return -1;
+
+    client->output_sent += bytes_send;
+  }
+
+  /* Everything is sent, reuse buffer from start */
+  client->output_len = 0;
+  client->output_sent = 0;
+
+  return 0;
+}
+
+/*
+ * pending_output - used to get amount of bytes waiting
+ * to be sent to client.
+ * @client - pointer to an object of client struct
+ *
+ * Return: amount of unsent bytes
+ */
+size_t pending_output(struct client* client) {
+  return client->output_len - client->output_sent;
+}
+
+/*
+ * free_client - used to close connection and free
+ * memory of client.
+ * @client - pointer to an object of client struct
+ */
+void free_client(struct client* client) {
+  close(client->fd);
+  free(client->message);
+  free(client->output);
+  free(client);
+}
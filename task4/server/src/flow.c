@@ -0,0 +1,241 @@
+#include "../headers/flow.h"
+
+/*
+ * create_flow_table - used to create empty table of flows.
+ * @capacity - initial amount of slots, power of two
+ *
+ * Return: pointer to an object of flow_table struct
+ */
+struct flow_table* create_flow_table(size_t capacity) {
+  struct flow_table* table = (struct flow_table*) calloc(1, sizeof(struct flow_table));
+  if (!table)
+    print_error("calloc");
+
+  table->flows = (struct flow*) calloc(capacity, sizeof(struct flow));
+  if (!table->flows)
+    print_error("calloc");
+  table->capacity = capacity;
+
+  return table;
+}
+
+/*
+ * hash_address - used to hash peer address. IPv4 address
+ * and port are mixed as one integer, other addresses are
+ * hashed as bytes.
+ * @addr - pointer to address
+ * @len - length of address
+ *
+ * Return: hash of address, never 0
+ */
+uint64_t hash_address(struct sockaddr* addr, socklen_t len) {
+  uint64_t hash;
+
+  if (addr->sa_family == AF_INET) {
+    struct sockaddr_in* in = (struct sockaddr_in*) addr;
+
+    /* Finalizer of MurmurHash3 */
+    hash = ((uint64_t) in->sin_addr.s_addr << 16) | in->sin_port;
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+  }
+  else
+    hash = hash_request((const char*) addr, len);
+
+  return hash ? hash : 1;
+}
+
+/*
+ * same_address - used to compare address of flow with
+ * address of datagram.
+ * @flow - pointer to an object of flow struct
+ * @addr - pointer to address
+ * @len - length of address
+ *
+ * Return: 1 if addresses are equal, 0 otherwise
+ */
+static int same_address(struct flow* flow, struct sockaddr* addr, socklen_t len) {
+  if (flow->addr_len != len || flow->addr.ss_family != addr->sa_family)
+    return 0;
+
+  if (addr->sa_family == AF_INET) {
+    struct sockaddr_in* a = (struct sockaddr_in*) &flow->addr;
+    struct sockaddr_in* b = (struct sockaddr_in*) addr;
+
+    return a->sin_addr.s_addr == b->sin_addr.s_addr && a->sin_port == b->sin_port;
+  }
+
+  return memcmp(&flow->addr, addr, len) == 0;
+}
+
+/*
+ * grow_table - used to double amount of slots and
+ * put flows to their new slots.
+ * @table - pointer to an object of flow_table struct
+ */
+static void grow_table(struct flow_table* table) {
+  struct flow* old = table->flows;
+  size_t old_capacity = table->capacity;
+  size_t mask;
+
+  table->capacity *= 2;
+  table->flows = (struct flow*) calloc(table->capacity, sizeof(struct flow));
+  if (!table->flows)
+    print_error("calloc");
+  mask = table->capacity - 1;
+
+  for (size_t i = 0; i < old_capacity; i++) {
+    size_t index;
+
+    if (!old[i].hash)
+      continue;
+
+    index = old[i].hash & mask;
+    while (table->flows[index].hash)
+      index = (index + 1) & mask;
+    table->flows[index] = old[i];
+  }
+
+  free(old);
+}
+
+/*
+ * find_flow - used to find flow of peer or start new one.
+ * Table grows while load is above FLOW_LOAD_PERCENT and
+ * stops accepting new peers at FLOW_TABLE_MAX slots.
+ * @table - pointer to an object of flow_table struct
+ * @addr - pointer to address of peer
+ * @len - length of address
+ * @now - current time in ms of monotonic clock
+ *
+ * Return: pointer to flow, NULL if table is full
+ */
+struct flow* find_flow(struct flow_table* table, struct sockaddr* addr, socklen_t len, uint64_t now) {
+  uint64_t hash = hash_address(addr, len);
+  size_t mask = table->capacity - 1;
+  size_t index = hash & mask;
+  struct flow* flow;
+
+  /* Probe until flow or empty slot */
+  while (table->flows[index].hash) {
+    flow = &table->flows[index];
+    if (flow->hash == hash && same_address(flow, addr, len))
+      return flow;
+    index = (index + 1) & mask;
+  }
+
+  /* Keep probes short */
+  if ((table->amount + 1) * 100 > table->capacity * FLOW_LOAD_PERCENT) {
+    if (table->capacity >= FLOW_TABLE_MAX)
+      return NULL;
+
+    grow_table(table);
+    mask = table->capacity - 1;
+    index = hash & mask;
+    while (table->flows[index].hash)
+      index = (index + 1) & mask;
+  }
+
+  /* Start flow of new peer */
+  flow = &table->flows[index];
+  memset(flow, 0, sizeof(*flow));
+  flow->hash = hash;
+  flow->addr_len = len;
+  memcpy(&flow->addr, addr, len);
+  format_address(addr, len, flow->name, sizeof(flow->name));
+  flow->last_seen = now;
+  flow->window_start = now;
+  table->amount++;
+
+  return flow;
+}
+
+/*
+ * update_flow - used to count datagrams of peer. Rate is
+ * amount of datagrams in last complete FLOW_RATE_WINDOW_MS.
+ * @flow - pointer to an object of flow struct
+ * @datagrams - amount of datagrams, more than 1 if coalesced
+ * @bytes - amount of received bytes
+ * @now - current time in ms of monotonic clock
+ */
+void update_flow(struct flow* flow, uint32_t datagrams, size_t bytes, uint64_t now) {
+  uint64_t elapsed = now - flow->window_start;
+
+  /* Close rate window, idle windows mean zero rate */
+  if (elapsed >= FLOW_RATE_WINDOW_MS) {
+    flow->rate = elapsed < 2 * FLOW_RATE_WINDOW_MS ? flow->window_datagrams : 0;
+    flow->window_datagrams = 0;
+    flow->window_start = now;
+  }
+
+  flow->window_datagrams += datagrams;
+  flow->seq += datagrams;
+  flow->bytes += bytes;
+  flow->last_seen = now;
+}
+
+/*
+ * remove_flow - used to empty slot. Following flows of
+ * cluster are shifted back to the hole if their home slot
+ * is not between hole and their slot, so they stay
+ * reachable from home without tombstones.
+ * @table - pointer to an object of flow_table struct
+ * @index - slot of flow
+ */
+static void remove_flow(struct flow_table* table, size_t index) {
+  size_t mask = table->capacity - 1;
+  size_t hole = index;
+  size_t next = (index + 1) & mask;
+
+  while (table->flows[next].hash) {
+    size_t home = table->flows[next].hash & mask;
+
+    if (((next - home) & mask) >= ((next - hole) & mask)) {
+      table->flows[hole] = table->flows[next];
+      hole = next;
+    }
+    next = (next + 1) & mask;
+  }
+
+  table->flows[hole].hash = 0;
+  table->amount--;
+}
+
+/*
+ * expire_flows - used to remove flows without datagrams
+ * for FLOW_TIMEOUT_MS. Slot is checked again after removal,
+ * as following flow may be shifted into it.
+ * @table - pointer to an object of flow_table struct
+ * @now - current time in ms of monotonic clock
+ *
+ * Return: amount of removed flows
+ */
+int expire_flows(struct flow_table* table, uint64_t now) {
+  int expired = 0;
+  size_t i = 0;
+
+  while (i < table->capacity) {
+    struct flow* flow = &table->flows[i];
+
+    if (flow->hash && flow->last_seen + FLOW_TIMEOUT_MS <= now) {
+      remove_flow(table, i);
+      expired++;
+      continue;
+    }
+    i++;
+  }
+
+  return expired;
+}
+
+/*
+ * free_flow_table - used to free table and its flows.
+ * @table - pointer to an object of flow_table struct
+ */
+void free_flow_table(struct flow_table* table) {
+  free(table->flows);
+  free(table);
+}
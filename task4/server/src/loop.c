@@ -0,0 +1,150 @@
+#include "../headers/loop.h"
+
+/*
+ * create_loop - used to create event loop over
+ * chosen multiplexer backend.
+ * @backend - LOOP_SELECT, LOOP_POLL or LOOP_EPOLL
+ * @max_events - max amount of events returned by one wait
+ *
+ * Return: pointer to an object of event_loop struct
+ */
+struct event_loop* create_loop(enum loop_backend backend, int max_events) {
+  struct event_loop* loop = (struct event_loop*) malloc(sizeof(struct event_loop));
+  if (!loop)
+    print_error("malloc");
+
+  if (backend == LOOP_SELECT)
+    loop->ops = &select_ops;
+  else if (backend == LOOP_POLL)
+    loop->ops = &poll_ops;
+  else
+    loop->ops = &epoll_ops;
+
+  loop->state = loop->ops->create();
+  loop->data = NULL;
+  loop->capacity = 0;
+  loop->max_events = max_events;
+
+  loop->events = (struct loop_event*) malloc(max_events * sizeof(struct loop_event));
+  if (!loop->events)
+    print_error("malloc");
+
+  return loop;
+}
+
+/*
+ * parse_backend - used to get backend by its name.
+ * @name - "select", "poll" or "epoll"
+ * @backend - pointer to store backend
+ *
+ * Return: 0 if name is known, -1 otherwise
+ */
+int parse_backend(const char* name, enum loop_backend* backend) {
+  if (strcmp(name, select_ops.name) == 0)
+    *backend = LOOP_SELECT;
+  else if (strcmp(name, poll_ops.name) == 0)
+    *backend = LOOP_POLL;
+  else if (strcmp(name, epoll_ops.name) == 0)
+    *backend = LOOP_EPOLL;
+  else
+    return -1;
+
+  return 0;
+}
+
+/*
+ * loop_register - used to start watching fd and
+ * attach data to it.
+ * @loop - pointer to an object of event_loop struct
+ * @fd - file descriptor to watch
+ * @events - LOOP_READ and LOOP_WRITE flags
+ * @data - data returned with events of fd
+ *
+ * Return: 0 if successful, -1 if backend can not watch fd
+ * (e.g. fd does not fit fd_set of select), errno is set
+ */
+int loop_register(struct event_loop* loop, int fd, uint32_t events, void* data) {
+  /* Grow data table to fit fd */
+  if (fd >= loop->capacity) {
+    int capacity = loop->capacity ? loop->capacity : 64;
+    void** table;
+
+    while (capacity <= fd)
+      capacity *= 2;
+
+    table = (void**) realloc(loop->data, capacity * sizeof(void*));
+    if (!table)
+      print_error("realloc");
+
+    memset(table + loop->capacity, 0, (capacity - loop->capacity) * sizeof(void*));
+    loop->data = table;
+    loop->capacity = capacity;
+  }
+
+  if (loop->ops->add(loop->state, fd, events) == -1)
+    return -1;
+
+  loop->data[fd] = data;
+
+  return 0;
+}
+
+/*
+ * loop_modify - used to change events watched on fd.
+ * @loop - pointer to an object of event_loop struct
+ * @fd - watched file descriptor
+ * @events - LOOP_READ and LOOP_WRITE flags
+ */
+void loop_modify(struct event_loop* loop, int fd, uint32_t events) {
+  if (loop->ops->modify(loop->state, fd, events) == -1)
+    print_error(loop->ops->name);
+}
+
+/*
+ * loop_unregister - used to stop watching fd. Should
+ * be called before fd is closed.
+ * @loop - pointer to an object of event_loop struct
+ * @fd - watched file descriptor
+ */
+void loop_unregister(struct event_loop* loop, int fd) {
+  if (loop->ops->remove(loop->state, fd) == -1)
+    print_error(loop->ops->name);
+
+  loop->data[fd] = NULL;
+}
+
+/*
+ * loop_wait - used to wait for events on watched fds.
+ * Ready events are stored in loop->events.
+ * @loop - pointer to an object of event_loop struct
+ * @timeout - timeout in ms, -1 to wait infinitely
+ *
+ * Return: amount of ready events
+ */
+int loop_wait(struct event_loop* loop, int timeout) {
+  int amount = loop->ops->wait(loop->state, loop->events, loop->max_events, timeout);
+
+  if (amount == -1) {
+    if (errno == EINTR)
+      return 0;
+    print_error(loop->ops->name);
+  }
+
+  /* Attach data to events */
+  for (int i = 0; i < amount; i++)
+    loop->events[i].data = loop->data[loop->events[i].fd];
+
+  return amount;
+}
+
+/*
+ * free_loop - used to free event loop and state
+ * of its backend.
+ * @loop - pointer to an object of event_loop struct
+ */
+void free_loop(struct event_loop* loop) {
+  loop->ops->destroy(loop->state);
+  free(loop->data);
+  free(loop->events);
+  free(loop);
+}
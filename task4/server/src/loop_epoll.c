@@ -0,0 +1,176 @@
+#include "../headers/loop.h"
+
+/**
+ * Used as state of epoll backend.
+ */
+struct epoll_state {
+  /* Epoll instance */
+  int epfd;
+
+  /* Buffer for epoll_wait */
+  struct epoll_event* events;
+
+  /* Size of buffer */
+  int size;
+};
+
+/*
+ * to_epoll - used to translate LOOP_* flags to epoll flags.
+ * @events - LOOP_* flags
+ *
+ * Return: epoll flags
+ */
+static uint32_t to_epoll(uint32_t events) {
+  uint32_t result = 0;
+
+  if (events & LOOP_READ)
+    result |= EPOLLIN;
+  if (events & LOOP_WRITE)
+    result |= EPOLLOUT;
+  if (events & LOOP_EXCLUSIVE)
+    result |= EPOLLEXCLUSIVE;
+  if (events & LOOP_EDGE)
+    result |= EPOLLET;
+  if (events & LOOP_ONESHOT)
+    result |= EPOLLONESHOT;
+
+  return result;
+}
+
+/*
+ * epoll_create_state - used to create state of epoll backend.
+ *
+ * Return: pointer to an object of epoll_state struct
+ */
+static void* epoll_create_state(void) {
+  struct epoll_state* state = (struct epoll_state*) calloc(1, sizeof(struct epoll_state));
+  if (!state)
+    print_error("calloc");
+
+  state->epfd = epoll_create1(EPOLL_CLOEXEC);
+  if (state->epfd == -1)
+    print_error("epoll_create1");
+
+  return state;
+}
+
+/*
+ * epoll_control - used to add or modify fd in epoll.
+ * @state - pointer to an object of epoll_state struct
+ * @op - EPOLL_CTL_ADD or EPOLL_CTL_MOD
+ * @fd - file descriptor
+ * @events - LOOP_* flags
+ *
+ * Return: result of epoll_ctl
+ */
+static int epoll_control(struct epoll_state* state, int op, int fd, uint32_t events) {
+  struct epoll_event ev;
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events = to_epoll(events);
+  ev.data.fd = fd;
+
+  return epoll_ctl(state->epfd, op, fd, &ev);
+}
+
+/*
+ * epoll_add - used to start watching fd.
+ * @opaque - pointer to an object of epoll_state struct
+ * @fd - file descriptor
+ * @events - LOOP_* flags
+ *
+ * Return: result of epoll_ctl
+ */
+static int epoll_add(void* opaque, int fd, uint32_t events) {
+  return epoll_control((struct epoll_state*) opaque, EPOLL_CTL_ADD, fd, events);
+}
+
+/*
+ * epoll_modify - used to change interest of fd.
+ * @opaque - pointer to an object of epoll_state struct
+ * @fd - file descriptor
+ * @events - LOOP_* flags
+ *
+ * Return: result of epoll_ctl
+ */
+static int epoll_modify(void* opaque, int fd, uint32_t events) {
+  return epoll_control((struct epoll_state*) opaque, EPOLL_CTL_MOD, fd, events);
+}
+
+/*
+ * epoll_remove - used to stop watching fd.
+ * @opaque - pointer to an object of epoll_state struct
+ * @fd - file descriptor
+ *
+ * Return: result of epoll_ctl
+ */
+static int epoll_remove(void* opaque, int fd) {
+  struct epoll_state* state = (struct epoll_state*) opaque;
+
+  return epoll_ctl(state->epfd, EPOLL_CTL_DEL, fd, NULL);
+}
+
+/*
+ * epoll_wait_events - used to wait for ready fds.
+ * @opaque - pointer to an object of epoll_state struct
+ * @events - array to store ready events
+ * @max_events - size of events array
+ * @timeout - timeout in ms, -1 to wait infinitely
+ *
+ * Return: amount of ready events, -1 on error
+ */
+static int epoll_wait_events(void* opaque, struct loop_event* events, int max_events, int timeout) {
+  struct epoll_state* state = (struct epoll_state*) opaque;
+  int amount;
+
+  /* Grow buffer for epoll_wait */
+  if (state->size < max_events) {
+    struct epoll_event* buffer = (struct epoll_event*) realloc(state->events, max_events * sizeof(struct epoll_event));
+    if (!buffer)
+      print_error("realloc");
+
+    state->events = buffer;
+    state->size = max_events;
+  }
+
+  amount = epoll_wait(state->epfd, state->events, max_events, timeout);
+
+  for (int i = 0; i < amount; i++) {
+    uint32_t revents = state->events[i].events;
+    uint32_t ready = 0;
+
+    if (revents & EPOLLIN)
+      ready |= LOOP_READ;
+    if (revents & EPOLLOUT)
+      ready |= LOOP_WRITE;
+    if (revents & (EPOLLERR | EPOLLHUP))
+      ready |= LOOP_ERROR;
+
+    events[i].fd = state->events[i].data.fd;
+    events[i].events = ready;
+  }
+
+  return amount;
+}
+
+/*
+ * epoll_destroy - used to free state of epoll backend.
+ * @opaque - pointer to an object of epoll_state struct
+ */
+static void epoll_destroy(void* opaque) {
+  struct epoll_state* state = (struct epoll_state*) opaque;
+
+  close(state->epfd);
+  free(state->events);
+  free(state);
+}
+
+const struct loop_ops epoll_ops = {
+  .name = "epoll",
+  .create = epoll_create_state,
+  .add = epoll_add,
+  .modify = epoll_modify,
+  .remove = epoll_remove,
+  .wait = epoll_wait_events,
+  .destroy = epoll_destroy,
+};
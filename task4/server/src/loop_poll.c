@@ -0,0 +1,212 @@
+#include "../headers/loop.h"
+
+/**
+ * Used as state of poll backend. Watched fds are
+ * kept packed in array, index of every fd is kept
+ * to update and remove it in constant time.
+ */
+struct poll_state {
+  /* Packed array of watched fds */
+  struct pollfd* fds;
+
+  /* Amount of watched fds */
+  int amount;
+
+  /* Size of fds array */
+  int size;
+
+  /* Position of fd in fds array, -1 if not watched */
+  int* index;
+
+  /* Size of index table */
+  int index_size;
+};
+
+/*
+ * to_poll - used to translate LOOP_* flags to poll flags.
+ * @events - LOOP_READ and LOOP_WRITE flags
+ *
+ * Return: poll flags
+ */
+static short to_poll(uint32_t events) {
+  short result = 0;
+
+  if (events & LOOP_READ)
+    result |= POLLIN;
+  if (events & LOOP_WRITE)
+    result |= POLLOUT;
+
+  return result;
+}
+
+/*
+ * poll_create - used to create state of poll backend.
+ *
+ * Return: pointer to an object of poll_state struct
+ */
+static void* poll_create(void) {
+  struct poll_state* state = (struct poll_state*) calloc(1, sizeof(struct poll_state));
+  if (!state)
+    print_error("calloc");
+
+  return state;
+}
+
+/*
+ * poll_add - used to start watching fd.
+ * @opaque - pointer to an object of poll_state struct
+ * @fd - file descriptor
+ * @events - LOOP_READ and LOOP_WRITE flags
+ *
+ * Return: 0 if successful, -1 if fd is watched already
+ */
+static int poll_add(void* opaque, int fd, uint32_t events) {
+  struct poll_state* state = (struct poll_state*) opaque;
+
+  /* Grow index table to fit fd */
+  if (fd >= state->index_size) {
+    int size = state->index_size ? state->index_size : 64;
+    int* index;
+
+    while (size <= fd)
+      size *= 2;
+
+    index = (int*) realloc(state->index, size * sizeof(int));
+    if (!index)
+      print_error("realloc");
+
+    for (int i = state->index_size; i < size; i++)
+      index[i] = -1;
+
+    state->index = index;
+    state->index_size = size;
+  }
+
+  if (state->index[fd] != -1) {
+    errno = EEXIST;
+    return -1;
+  }
+
+  /* Grow fds array */
+  if (state->amount == state->size) {
+    int size = state->size ? state->size * 2 : 64;
+    struct pollfd* fds = (struct pollfd*) realloc(state->fds, size * sizeof(struct pollfd));
+    if (!fds)
+      print_error("realloc");
+
+    state->fds = fds;
+    state->size = size;
+  }
+
+  state->fds[state->amount].fd = fd;
+  state->fds[state->amount].events = to_poll(events);
+  state->fds[state->amount].revents = 0;
+  state->index[fd] = state->amount++;
+
+  return 0;
+}
+
+/*
+ * poll_modify - used to change interest of fd.
+ * @opaque - pointer to an object of poll_state struct
+ * @fd - file descriptor
+ * @events - LOOP_READ and LOOP_WRITE flags
+ *
+ * Return: 0 if successful, -1 if fd is not watched
+ */
+static int poll_modify(void* opaque, int fd, uint32_t events) {
+  struct poll_state* state = (struct poll_state*) opaque;
+
+  if (fd < 0 || fd >= state->index_size || state->index[fd] == -1) {
+    errno = ENOENT;
+    return -1;
+  }
+
+  state->fds[state->index[fd]].events = to_poll(events);
+
+  return 0;
+}
+
+/*
+ * poll_remove - used to stop watching fd. Last fd
+ * takes place of removed one.
+ * @opaque - pointer to an object of poll_state struct
+ * @fd - file descriptor
+ *
+ * Return: 0 if successful, -1 if fd is not watched
+ */
+static int poll_remove(void* opaque, int fd) {
+  struct poll_state* state = (struct poll_state*) opaque;
+  int position;
+
+  if (fd < 0 || fd >= state->index_size || state->index[fd] == -1) {
+    errno = ENOENT;
+    return -1;
+  }
+
+  position = state->index[fd];
+  state->fds[position] = state->fds[--state->amount];
+  state->index[state->fds[position].fd] = position;
+  state->index[fd] = -1;
+
+  return 0;
+}
+
+/*
+ * poll_wait - used to wait for ready fds.
+ * @opaque - pointer to an object of poll_state struct
+ * @events - array to store ready events
+ * @max_events - size of events array
+ * @timeout - timeout in ms, -1 to wait infinitely
+ *
+ * Return: amount of ready events, -1 on error
+ */
+static int poll_wait(void* opaque, struct loop_event* events, int max_events, int timeout) {
+  struct poll_state* state = (struct poll_state*) opaque;
+  int amount = 0;
+
+  if (poll(state->fds, state->amount, timeout) == -1)
+    return -1;
+
+  for (int i = 0; i < state->amount && amount < max_events; i++) {
+    short revents = state->fds[i].revents;
+    uint32_t ready = 0;
+
+    if (revents & POLLIN)
+      ready |= LOOP_READ;
+    if (revents & POLLOUT)
+      ready |= LOOP_WRITE;
+    if (revents & (POLLERR | POLLHUP | POLLNVAL))
+      ready |= LOOP_ERROR;
+
+    if (ready) {
+      events[amount].fd = state->fds[i].fd;
+      events[amount].events = ready;
+      amount++;
+    }
+  }
+
+  return amount;
+}
+
+/*
+ * poll_destroy - used to free state of poll backend.
+ * @opaque - pointer to an object of poll_state struct
+ */
+static void poll_destroy(void* opaque) {
+  struct poll_state* state = (struct poll_state*) opaque;
+
+  free(state->fds);
+  free(state->index);
+  free(state);
+}
+
+const struct loop_ops poll_ops = {
+  .name = "poll",
+  .create = poll_create,
+  .add = poll_add,
+  .modify = poll_modify,
+  .remove = poll_remove,
+  .wait = poll_wait,
+  .destroy = poll_destroy,
+};
@@ -0,0 +1,160 @@
+#include "../headers/loop.h"
+
+/**
+ * Used as state of select backend. Sets of
+ * interest are copied before every wait.
+ */
+struct select_state {
+  /* Fds watched for reading */
+  fd_set read_fds;
+
+  /* Fds watched for writing */
+  fd_set write_fds;
+
+  /* Max watched fd, -1 if none */
+  int max_fd;
+};
+
+/*
+ * select_create - used to create state of select backend.
+ *
+ * Return: pointer to an object of select_state struct
+ */
+static void* select_create(void) {
+  struct select_state* state = (struct select_state*) malloc(sizeof(struct select_state));
+  if (!state)
+    print_error("malloc");
+
+  FD_ZERO(&state->read_fds);
+  FD_ZERO(&state->write_fds);
+  state->max_fd = -1;
+
+  return state;
+}
+
+/*
+ * select_modify - used to set interest of fd.
+ * @opaque - pointer to an object of select_state struct
+ * @fd - file descriptor
+ * @events - LOOP_READ and LOOP_WRITE flags
+ *
+ * Return: 0 if successful, -1 if fd does not fit fd_set
+ */
+static int select_modify(void* opaque, int fd, uint32_t events) {
+  struct select_state* state = (struct select_state*) opaque;
+
+  if (fd < 0 || fd >= FD_SETSIZE) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  FD_CLR(fd, &state->read_fds);
+  FD_CLR(fd, &state->write_fds);
+
+  if (events & LOOP_READ)
+    FD_SET(fd, &state->read_fds);
+  if (events & LOOP_WRITE)
+    FD_SET(fd, &state->write_fds);
+
+  return 0;
+}
+
+/*
+ * select_add - used to start watching fd.
+ * @opaque - pointer to an object of select_state struct
+ * @fd - file descriptor
+ * @events - LOOP_READ and LOOP_WRITE flags
+ *
+ * Return: 0 if successful, -1 if fd does not fit fd_set
+ */
+static int select_add(void* opaque, int fd, uint32_t events) {
+  struct select_state* state = (struct select_state*) opaque;
+
+  if (select_modify(opaque, fd, events) == -1)
+    return -1;
+
+  if (fd > state->max_fd)
+    state->max_fd = fd;
+
+  return 0;
+}
+
+/*
+ * select_remove - used to stop watching fd.
+ * @opaque - pointer to an object of select_state struct
+ * @fd - file descriptor
+ *
+ * Return: 0 if successful, -1 if fd does not fit fd_set
+ */
+static int select_remove(void* opaque, int fd) {
+  struct select_state* state = (struct select_state*) opaque;
+
+  if (select_modify(opaque, fd, 0) == -1)
+    return -1;
+
+  /* Find new max fd */
+  while (state->max_fd >= 0
+         && !FD_ISSET(state->max_fd, &state->read_fds)
+         && !FD_ISSET(state->max_fd, &state->write_fds))
+    state->max_fd--;
+
+  return 0;
+}
+
+/*
+ * select_wait - used to wait for ready fds.
+ * @opaque - pointer to an object of select_state struct
+ * @events - array to store ready events
+ * @max_events - size of events array
+ * @timeout - timeout in ms, -1 to wait infinitely
+ *
+ * Return: amount of ready events, -1 on error
+ */
+static int select_wait(void* opaque, struct loop_event* events, int max_events, int timeout) {
+  struct select_state* state = (struct select_state*) opaque;
+  struct timeval tv;
+  fd_set read_fds = state->read_fds;
+  fd_set write_fds = state->write_fds;
+  int amount = 0;
+
+  tv.tv_sec = timeout / 1000;
+  tv.tv_usec = (timeout % 1000) * 1000;
+
+  if (select(state->max_fd + 1, &read_fds, &write_fds, NULL, timeout < 0 ? NULL : &tv) == -1)
+    return -1;
+
+  for (int fd = 0; fd <= state->max_fd && amount < max_events; fd++) {
+    uint32_t ready = 0;
+
+    if (FD_ISSET(fd, &read_fds))
+      ready |= LOOP_READ;
+    if (FD_ISSET(fd, &write_fds))
+      ready |= LOOP_WRITE;
+
+    if (ready) {
+      events[amount].fd = fd;
+      events[amount].events = ready;
+      amount++;
+    }
+  }
+
+  return amount;
+}
+
+/*
+ * select_destroy - used to free state of select backend.
+ * @opaque - pointer to an object of select_state struct
+ */
+static void select_destroy(void* opaque) {
+  free(opaque);
+}
+
+const struct loop_ops select_ops = {
+  .name = "select",
+  .create = select_create,
+  .add = select_add,
+  .modify = select_modify,
+  .remove = select_remove,
+  .wait = select_wait,
+  .destroy = select_destroy,
+};
@@ -4,13 +4,45 @@ struct server* server;
 
 void cleanup();
 
-int main(void) {
-  server = create_server(SERVER_IP, SERVER_PORT);
+void usage(const char* name);
+
+int main(int argc, char** argv) {
+  struct server_config config = { LOOP_EPOLL, 1, 0, 0, 0, 0 };
+  int opt;
+
+  /* Choose multiplexer, amount of event loops and mode of waits */
+  while ((opt = getopt(argc, argv, "m:t:xeob:")) != -1) {
+    if (opt == 'm' && parse_backend(optarg, &config.backend) == 0)
+      continue;
+    else if (opt == 't' && (config.workers = atoi(optarg)) > 0 && config.workers <= MAX_WORKERS)
+      continue;
+    else if (opt == 'x')
+      config.exclusive = 1;
+    else if (opt == 'e')
+      config.edge = 1;
+    else if (opt == 'o')
+      config.oneshot = 1;
+    else if (opt == 'b' && (config.busy_poll = atoi(optarg)) > 0 && config.busy_poll <= MAX_BUSY_POLL_US)
+      continue;
+    else
+      usage(argv[0]);
+  }
+
+  /* Edge-triggered and one-shot modes exist only in epoll */
+  if ((config.edge || config.oneshot) && config.backend != LOOP_EPOLL)
+    usage(argv[0]);
+
+  server = create_server(SERVER_IP, SERVER_PORT, &config);
   atexit(cleanup);
   run_server(server); 
   exit(EXIT_SUCCESS);
 }
 
+void usage(const char* name) {
+  fprintf(stderr, "Usage: %s [-m select|poll|epoll] [-t workers] [-x] [-e] [-o] [-b usec]\n", name);
+  exit(EXIT_FAILURE);
+}
+
 void cleanup() {
   free_server(server);  
 }
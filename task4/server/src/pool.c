@@ -0,0 +1,114 @@
+#include "../headers/pool.h"
+
+/*
+ * allocate_buffer - used to allocate buffer of size class.
+ * @pool - pointer to an object of buffer_pool struct
+ * @size_class - size class of buffer
+ *
+ * Return: pointer to header of buffer
+ */
+static struct pool_buffer* allocate_buffer(struct buffer_pool* pool, int size_class) {
+  struct pool_buffer* buffer = (struct pool_buffer*) malloc(sizeof(struct pool_buffer) + class_size(size_class));
+  if (!buffer)
+    print_error("malloc");
+
+  buffer->size_class = size_class;
+  buffer->next = NULL;
+  pool->allocated[size_class]++;
+
+  return buffer;
+}
+
+/*
+ * create_buffer_pool - used to create pool with amount
+ * of preallocated buffers in every size class.
+ * @amount - amount of buffers of every class
+ *
+ * Return: pointer to an object of buffer_pool struct
+ */
+struct buffer_pool* create_buffer_pool(int amount) {
+  struct buffer_pool* pool = (struct buffer_pool*) calloc(1, sizeof(struct buffer_pool));
+  if (!pool)
+    print_error("calloc");
+
+  for (int i = 0; i < POOL_CLASSES; i++) {
+    for (int j = 0; j < amount; j++) {
+      struct pool_buffer* buffer = allocate_buffer(pool, i);
+
+      buffer->next = pool->free[i];
+      pool->free[i] = buffer;
+    }
+  }
+
+  return pool;
+}
+
+/*
+ * class_size - used to get size of buffers of class.
+ * @size_class - size class
+ *
+ * Return: size of buffer in bytes
+ */
+size_t class_size(int size_class) {
+  size_t size = POOL_MIN_BUFFER;
+
+  for (int i = 0; i < size_class; i++)
+    size *= POOL_CLASS_STEP;
+
+  return size;
+}
+
+/*
+ * pool_get - used to take buffer of smallest class that
+ * holds size. Buffer is allocated if class has no free
+ * buffers and stays in pool after it is returned.
+ * @pool - pointer to an object of buffer_pool struct
+ * @size - needed size in bytes, not bigger than largest class
+ *
+ * Return: pointer to data of buffer
+ */
+char* pool_get(struct buffer_pool* pool, size_t size) {
+  struct pool_buffer* buffer;
+  int size_class = 0;
+
+  while (class_size(size_class) < size)
+    size_class++;
+
+  buffer = pool->free[size_class];
+  if (buffer)
+    pool->free[size_class] = buffer->next;
+  else
+    buffer = allocate_buffer(pool, size_class);
+
+  return (char*) (buffer + 1);
+}
+
+/*
+ * pool_put - used to return buffer to free buffers of
+ * its class.
+ * @pool - pointer to an object of buffer_pool struct
+ * @buffer - pointer to data of buffer taken by pool_get
+ */
+void pool_put(struct buffer_pool* pool, char* buffer) {
+  struct pool_buffer* header = (struct pool_buffer*) buffer - 1;
+
+  header->next = pool->free[header->size_class];
+  pool->free[header->size_class] = header;
+}
+
+/*
+ * free_buffer_pool - used to free pool and its buffers.
+ * Buffers must be returned to pool before.
+ * @pool - pointer to an object of buffer_pool struct
+ */
+void free_buffer_pool(struct buffer_pool* pool) {
+  for (int i = 0; i < POOL_CLASSES; i++) {
+    while (pool->free[i]) {
+      struct pool_buffer* buffer = pool->free[i];
+
+      pool->free[i] = buffer->next;
+      free(buffer);
+    }
+  }
+  free(pool);
+}
@@ -0,0 +1,196 @@
+#include "../headers/timer.h"
+
+/*
+ * create_timer_queue - used to create empty queue of timers.
+ *
+ * Return: pointer to an object of timer_queue struct
+ */
+struct timer_queue* create_timer_queue(void) {
+  struct timer_queue* queue = (struct timer_queue*) calloc(1, sizeof(struct timer_queue));
+  if (!queue)
+    print_error("calloc");
+
+  return queue;
+}
+
+/*
+ * init_timer - used to initialize timer that is not scheduled.
+ * @timer - pointer to an object of timer struct
+ * @callback - function called when timer expires
+ * @data - argument of callback
+ */
+void init_timer(struct timer* timer, timer_callback callback, void* data) {
+  timer->expires = 0;
+  timer->callback = callback;
+  timer->data = data;
+  timer->index = -1;
+}
+
+/*
+ * place_timer - used to put timer at position of heap.
+ * @queue - pointer to an object of timer_queue struct
+ * @timer - pointer to an object of timer struct
+ * @index - position in heap
+ */
+static void place_timer(struct timer_queue* queue, struct timer* timer, int index) {
+  queue->heap[index] = timer;
+  timer->index = index;
+}
+
+/*
+ * sift_up - used to move timer to root while it expires
+ * earlier than its parent.
+ * @queue - pointer to an object of timer_queue struct
+ * @index - position of timer in heap
+ */
+static void sift_up(struct timer_queue* queue, int index) {
+  struct timer* timer = queue->heap[index];
+
+  while (index > 0) {
+    int parent = (index - 1) / 2;
+    if (queue->heap[parent]->expires <= timer->expires)
+      break;
+
+    place_timer(queue, queue->heap[parent], index);
+    index = parent;
+  }
+
+  place_timer(queue, timer, index);
+}
+
+/*
+ * sift_down - used to move timer to leaves while one of
+ * its children expires earlier.
+ * @queue - pointer to an object of timer_queue struct
+ * @index - position of timer in heap
+ */
+static void sift_down(struct timer_queue* queue, int index) {
+  struct timer* timer = queue->heap[index];
+
+  while (1) {
+    int child = 2 * index + 1;
+    if (child >= queue->amount)
+      break;
+
+    if (child + 1 < queue->amount && queue->heap[child + 1]->expires < queue->heap[child]->expires)
+      child++;
+    if (timer->expires <= queue->heap[child]->expires)
+      break;
+
+    place_timer(queue, queue->heap[child], index);
+    index = child;
+  }
+
+  place_timer(queue, timer, index);
+}
+
+/*
+ * schedule_timer - used to schedule timer or move already
+ * scheduled one to new expiration time.
+ * @queue - pointer to an object of timer_queue struct
+ * @timer - pointer to an object of timer struct
+ * @expires - time of expiration in ms of monotonic clock
+ */
+void schedule_timer(struct timer_queue* queue, struct timer* timer, uint64_t expires) {
+  /* Move scheduled timer */
+  if (timer->index != -1) {
+    uint64_t previous = timer->expires;
+
+    timer->expires = expires;
+    if (expires < previous)
+      sift_up(queue, timer->index);
+    else
+      sift_down(queue, timer->index);
+    return;
+  }
+
+  /* Grow heap */
+  if (queue->amount == queue->size) {
+    int size = queue->size ? queue->size * 2 : 64;
+    struct timer** heap = (struct timer**) realloc(queue->heap, size * sizeof(struct timer*));
+    if (!heap)
+      print_error("realloc");
+
+    queue->heap = heap;
+    queue->size = size;
+  }
+
+  timer->expires = expires;
+  place_timer(queue, timer, queue->amount++);
+  sift_up(queue, timer->index);
+}
+
+/*
+ * cancel_timer - used to remove timer from queue. Does
+ * nothing if timer is not scheduled.
+ * @queue - pointer to an object of timer_queue struct
+ * @timer - pointer to an object of timer struct
+ */
+void cancel_timer(struct timer_queue* queue, struct timer* timer) {
+  int index = timer->index;
+  struct timer* last;
+
+  if (index == -1)
+    return;
+
+  timer->index = -1;
+  last = queue->heap[--queue->amount];
+  if (last == timer)
+    return;
+
+  /* Last timer takes place of removed one */
+  place_timer(queue, last, index);
+  if (index > 0 && queue->heap[(index - 1) / 2]->expires > last->expires)
+    sift_up(queue, index);
+  else
+    sift_down(queue, index);
+}
+
+/*
+ * next_timeout - used to get timeout for wait of event
+ * loop, so it wakes up when nearest timer expires.
+ * @queue - pointer to an object of timer_queue struct
+ * @now - current time in ms of monotonic clock
+ *
+ * Return: timeout in ms, -1 if no timers are scheduled
+ */
+int next_timeout(struct timer_queue* queue, uint64_t now) {
+  uint64_t expires;
+
+  if (queue->amount == 0)
+    return -1;
+
+  expires = queue->heap[0]->expires;
+  if (expires <= now)
+    return 0;
+  if (expires - now > INT32_MAX)
+    return INT32_MAX;
+
+  return (int) (expires - now);
+}
+
+/*
+ * run_timers - used to call callbacks of expired timers.
+ * Timer is removed before its callback, so callback may
+ * schedule it again or free its object.
+ * @queue - pointer to an object of timer_queue struct
+ * @now - current time in ms of monotonic clock
+ */
+void run_timers(struct timer_queue* queue, uint64_t now) {
+  while (queue->amount > 0 && queue->heap[0]->expires <= now) {
+    struct timer* timer = queue->heap[0];
+
+    cancel_timer(queue, timer);
+    timer->callback(timer, timer->data);
+  }
+}
+
+/*
+ * free_timer_queue - used to free queue. Timers belong
+ * to their objects and are not freed.
+ * @queue - pointer to an object of timer_queue struct
+ */
+void free_timer_queue(struct timer_queue* queue) {
+  free(queue->heap);
+  free(queue);
+}
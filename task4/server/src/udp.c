@@ -0,0 +1,238 @@
+#include "../headers/udp.h"
+
+/*
+ * create_udp_batch - used to preallocate headers, buffers
+ * and addresses for batched UDP I/O.
+ * @offload - 1 if GRO and GSO are enabled on socket
+ * @pool - pointer to pool of replies
+ *
+ * Return: pointer to an object of udp_batch struct
+ */
+struct udp_batch* create_udp_batch(int offload, struct buffer_pool* pool) {
+  struct udp_batch* batch = (struct udp_batch*) calloc(1, sizeof(struct udp_batch));
+  if (!batch)
+    print_error("calloc");
+
+  /* Coalesced datagram holds many segments */
+  batch->offload = offload;
+  batch->pool = pool;
+  batch->buffer_size = offload ? UDP_GRO_BUFFER : UDP_MAX_PAYLOAD;
+  batch->capacity = offload ? UDP_BATCH * UDP_MAX_SEGMENTS : UDP_BATCH;
+
+  batch->recv_msgs = (struct mmsghdr*) calloc(UDP_BATCH, sizeof(struct mmsghdr));
+  batch->recv_iovs = (struct iovec*) calloc(UDP_BATCH, sizeof(struct iovec));
+  batch->addrs = (struct sockaddr_storage*) calloc(UDP_BATCH, sizeof(struct sockaddr_storage));
+  batch->buffers = (char*) malloc(UDP_BATCH * (batch->buffer_size + 1));
+  batch->recv_controls = (char*) calloc(UDP_BATCH, UDP_CONTROL_SIZE);
+  batch->send_msgs = (struct mmsghdr*) calloc(batch->capacity, sizeof(struct mmsghdr));
+  batch->send_iovs = (struct iovec*) calloc(batch->capacity, sizeof(struct iovec));
+  batch->send_controls = (char*) calloc(batch->capacity, UDP_CONTROL_SIZE);
+  batch->replies = (char**) calloc(batch->capacity, sizeof(char*));
+  if (!batch->recv_msgs || !batch->recv_iovs || !batch->addrs || !batch->buffers ||
+      !batch->recv_controls || !batch->send_msgs || !batch->send_iovs ||
+      !batch->send_controls || !batch->replies)
+    print_error("calloc");
+
+  /* Point receive headers to their buffers */
+  for (int i = 0; i < UDP_BATCH; i++) {
+    batch->recv_iovs[i].iov_base = batch_buffer(batch, i);
+    batch->recv_iovs[i].iov_len = batch->buffer_size;
+    batch->recv_msgs[i].msg_hdr.msg_name = &batch->addrs[i];
+    batch->recv_msgs[i].msg_hdr.msg_iov = &batch->recv_iovs[i];
+    batch->recv_msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  return batch;
+}
+
+/*
+ * recv_batch - used to receive up to UDP_BATCH datagrams
+ * with one recvmmsg call. Does not block.
+ * @fd - file descriptor of UDP or AF_UNIX datagram socket
+ * @batch - pointer to an object of udp_batch struct
+ *
+ * Return: amount of received datagrams
+ */
+int recv_batch(int fd, struct udp_batch* batch) {
+  int amount;
+
+  /* Reset fields changed by previous call */
+  for (int i = 0; i < UDP_BATCH; i++) {
+    struct msghdr* hdr = &batch->recv_msgs[i].msg_hdr;
+
+    hdr->msg_namelen = sizeof(struct sockaddr_storage);
+    hdr->msg_control = batch->offload ? batch->recv_controls + i * UDP_CONTROL_SIZE : NULL;
+    hdr->msg_controllen = batch->offload ? UDP_CONTROL_SIZE : 0;
+    hdr->msg_flags = 0;
+  }
+
+  do {
+    amount = recvmmsg(fd, batch->recv_msgs, UDP_BATCH, MSG_DONTWAIT, NULL);
+  } while (amount == -1 && errno == EINTR);
+
+  if (amount == -1) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+      return 0;
+    print_error("recvmmsg");
+  }
+
+  return amount;
+}
+
+/*
+ * batch_buffer - used to get receive buffer of datagram.
+ * @batch - pointer to an object of udp_batch struct
+ * @index - index of datagram in batch
+ *
+ * Return: pointer to buffer of buffer_size + 1 bytes
+ */
+char* batch_buffer(struct udp_batch* batch, int index) {
+  return batch->buffers + index * (batch->buffer_size + 1);
+}
+
+/*
+ * segment_size - used to get size of segments coalesced
+ * by GRO into received datagram.
+ * @batch - pointer to an object of udp_batch struct
+ * @index - index of datagram in batch
+ *
+ * Return: size of segment, whole length if not coalesced
+ */
+size_t segment_size(struct udp_batch* batch, int index) {
+  struct msghdr* hdr = &batch->recv_msgs[index].msg_hdr;
+
+  if (batch->offload) {
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(hdr); cmsg; cmsg = CMSG_NXTHDR(hdr, cmsg)) {
+      if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+        int size;
+        memcpy(&size, CMSG_DATA(cmsg), sizeof(size));
+        return size;
+      }
+    }
+  }
+
+  return batch->recv_msgs[index].msg_len;
+}
+
+/*
+ * add_reply - used to keep reply until batch is sent.
+ * Reply is dropped if batch is full.
+ * @batch - pointer to an object of udp_batch struct
+ * @reply - reply taken from pool, returned after it is sent
+ */
+void add_reply(struct udp_batch* batch, char* reply) {
+  if (batch->reply_amount == batch->capacity) {
+    pool_put(batch->pool, reply);
+    return;
+  }
+
+  batch->send_iovs[batch->reply_amount].iov_base = reply;
+  batch->send_iovs[batch->reply_amount].iov_len = strlen(reply);
+  batch->replies[batch->reply_amount++] = reply;
+}
+
+/*
+ * queue_replies - used to prepare headers for replies added
+ * since first to one client. If GSO is enabled and replies
+ * have same size (last one may be shorter), they are sent
+ * as one super datagram split by kernel, otherwise every
+ * reply gets own header.
+ * @batch - pointer to an object of udp_batch struct
+ * @addr - pointer to address of the client
+ * @len - length of address
+ * @first - index of first reply to the client
+ */
+void queue_replies(struct udp_batch* batch, struct sockaddr* addr, socklen_t len, int first) {
+  int amount = batch->reply_amount - first;
+  size_t size = amount > 0 ? batch->send_iovs[first].iov_len : 0;
+  size_t total = 0;
+  int gso = batch->offload && amount > 1 && amount <= UDP_MAX_SEGMENTS && size > 0;
+
+  for (int i = first; i < batch->reply_amount && gso; i++) {
+    total += batch->send_iovs[i].iov_len;
+    if (batch->send_iovs[i].iov_len > size ||
+        (batch->send_iovs[i].iov_len < size && i != batch->reply_amount - 1))
+      gso = 0;
+  }
+  if (total > UDP_MAX_PAYLOAD)
+    gso = 0;
+
+  for (int i = first; i < batch->reply_amount; i++) {
+    struct msghdr* hdr = &batch->send_msgs[batch->send_amount].msg_hdr;
+
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->msg_name = addr;
+    hdr->msg_namelen = len;
+    hdr->msg_iov = &batch->send_iovs[i];
+    hdr->msg_iovlen = gso ? amount : 1;
+
+    /* Kernel splits super datagram in segments of size */
+    if (gso) {
+      struct cmsghdr* cmsg;
+      uint16_t segment = size;
+
+      hdr->msg_control = batch->send_controls + batch->send_amount * UDP_CONTROL_SIZE;
+      hdr->msg_controllen = CMSG_SPACE(sizeof(segment));
+      cmsg = CMSG_FIRSTHDR(hdr);
+      cmsg->cmsg_level = SOL_UDP;
+      cmsg->cmsg_type = UDP_SEGMENT;
+      cmsg->cmsg_len = CMSG_LEN(sizeof(segment));
+      memcpy(CMSG_DATA(cmsg), &segment, sizeof(segment));
+    }
+
+    batch->send_amount++;
+    if (gso)
+      break;
+  }
+}
+
+/*
+ * flush_batch - used to send all queued replies with
+ * sendmmsg and return them to pool. Replies that socket can not
+ * take are dropped as UDP allows.
+ * @fd - file descriptor of UDP or AF_UNIX datagram socket
+ * @batch - pointer to an object of udp_batch struct
+ */
+void flush_batch(int fd, struct udp_batch* batch) {
+  int sent = 0;
+
+  while (sent < batch->send_amount) {
+    int result = sendmmsg(fd, batch->send_msgs + sent, batch->send_amount - sent, MSG_DONTWAIT);
+
+    if (result == -1) {
+      if (errno == EINTR)
+        continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        break;
+
+      /* Skip datagram that failed */
+      sent++;
+      continue;
+    }
+
+    sent += result;
+  }
+
+  for (int i = 0; i < batch->reply_amount; i++)
+    pool_put(batch->pool, batch->replies[i]);
+
+  batch->send_amount = 0;
+  batch->reply_amount = 0;
+}
+
+/*
+ * free_udp_batch - used to free memory of batch.
+ * @batch - pointer to an object of udp_batch struct
+ */
+void free_udp_batch(struct udp_batch* batch) {
+  free(batch->recv_msgs);
+  free(batch->recv_iovs);
+  free(batch->addrs);
+  free(batch->buffers);
+  free(batch->recv_controls);
+  free(batch->send_msgs);
+  free(batch->send_iovs);
+  free(batch->send_controls);
+  free(batch->replies);
+  free(batch);
+}
@@ -0,0 +1,663 @@
+#include "../headers/server.h"
+#include <inttypes.h>
+#include <limits.h>
+
+/*
+ * create_worker - used to create an object of worker struct
+ * with own event loop, timers and UDP buffers. In SO_REUSEPORT
+ * mode worker also opens own TCP and UDP sockets. AF_UNIX
+ * sockets are always shared.
+ * @server - pointer to an object of server struct
+ * @id - id of worker
+ *
+ * Return: pointer to an object of worker struct
+ */
+struct worker* create_worker(struct server* server, int id) {
+  struct worker* worker = (struct worker*) calloc(1, sizeof(struct worker));
+  if (!worker)
+    print_error("calloc");
+
+  worker->server = server;
+  worker->id = id;
+
+  /* Initialize event loop */
+  worker->loop = create_loop(server->config.backend, LOOP_EVENTS);
+  
+  /* Initialize buffers for UDP requests */
+  worker->pool = create_buffer_pool(UDP_BATCH);
+  worker->udp_batch = create_udp_batch(UDP_OFFLOAD, worker->pool);
+  worker->unix_batch = create_udp_batch(0, worker->pool);
+  
+  /* Initialize state of datagram peers */
+  worker->flows = create_flow_table(FLOW_TABLE_SIZE);
+
+  /* Initialize timers */
+  worker->timers = create_timer_queue();
+  init_timer(&worker->stats_timer, flush_stats, worker);
+  init_timer(&worker->flow_timer, sweep_flows, worker);
+  worker->now = monotonic_ms();
+
+  /* Listeners of server are shared by workers */
+  if (server->tcp_fd != -1) {
+    worker->tcp_fd = server->tcp_fd;
+    worker->udp_fd = server->udp_fd;
+  }
+  /* Kernel spreads connections and datagrams over own sockets */
+  else {
+    worker->tcp_fd = open_socket(SOCK_STREAM, server->config.workers > 1);
+    worker->udp_fd = open_socket(SOCK_DGRAM, server->config.workers > 1);
+    bind_sockets(server, worker->tcp_fd, worker->udp_fd);
+  }
+
+  worker->unix_stream_fd = server->unix_stream_fd;
+  worker->unix_dgram_fd = server->unix_dgram_fd;
+
+  return worker;
+}
+
+/*
+ * start_worker - used to register listening sockets in
+ * event loop of worker and run it in own thread pinned
+ * to CPU. Shared listeners are registered exclusive, so
+ * one worker is woken per event. In edge-triggered mode
+ * listeners are drained until EAGAIN on every event.
+ * @worker - pointer to an object of worker struct
+ */
+void start_worker(struct worker* worker) {
+  uint32_t events = LOOP_READ;
+  uint32_t shared;
+
+  if (worker->server->config.edge)
+    events |= LOOP_EDGE;
+
+  shared = worker->server->config.workers > 1 ? events | LOOP_EXCLUSIVE : events;
+
+  /* Watch listening sockets */
+  if (loop_register(worker->loop, worker->tcp_fd, worker->tcp_fd == worker->server->tcp_fd ? shared : events, NULL) == -1 ||
+      loop_register(worker->loop, worker->udp_fd, worker->udp_fd == worker->server->udp_fd ? shared : events, NULL) == -1 ||
+      loop_register(worker->loop, worker->unix_stream_fd, shared, NULL) == -1 ||
+      loop_register(worker->loop, worker->unix_dgram_fd, shared, NULL) == -1)
+    print_error(worker->loop->ops->name);
+
+  /* Start statistics */
+  worker->now = monotonic_ms();
+  schedule_timer(worker->timers, &worker->stats_timer, worker->now + STATS_INTERVAL_MS);
+  schedule_timer(worker->timers, &worker->flow_timer, worker->now + FLOW_SWEEP_MS);
+  worker->last_arrival = monotonic_ns();
+
+  if (pthread_create(&worker->thread, NULL, run_worker, worker) != 0)
+    print_error("pthread_create");
+}
+
+/*
+ * run_worker - used as thread function of worker. Pins
+ * thread to CPU and runs event loop.
+ * @arg - pointer to an object of worker struct
+ *
+ * Return: NULL
+ */
+void* run_worker(void* arg) {
+  struct worker* worker = (struct worker*) arg;
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+  /* Pin thread to CPU */
+  if (cpus > 0) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(worker->id % cpus, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  }
+
+  run_loop(worker);
+
+  return NULL;
+}
+
+/*
+ * run_loop - used to run event loop over listening
+ * and client fds. New connections are accepted, ready
+ * clients are served by their state machines and UDP
+ * requests are answered, so all of them are served
+ * together. Wait ends not later than nearest timer
+ * expires, then expired timers are run.
+ * @worker - pointer to an object of worker struct 
+ */
+void run_loop(struct worker* worker) {
+  while (1) {
+    int timeout = next_timeout(worker->timers, monotonic_ms());
+    int amount = wait_events(worker, timeout);
+
+    worker->now = monotonic_ms();
+
+    for (int i = 0; i < amount; i++) {
+      struct loop_event* event = &worker->loop->events[i];
+
+      /* TCP or local stream connection */
+      if (event->fd == worker->tcp_fd || event->fd == worker->unix_stream_fd) {
+        accept_clients(worker, event->fd);
+      }
+      /* UDP request */
+      else if (event->fd == worker->udp_fd) {
+        communicate_udp(worker, worker->udp_fd, worker->udp_batch);
+      }
+      /* Local datagram request */
+      else if (event->fd == worker->unix_dgram_fd) {
+        communicate_udp(worker, worker->unix_dgram_fd, worker->unix_batch);
+      }
+      /* Data from client or socket ready for replies */
+      else if (event->data) {
+        communicate_tcp(worker, (struct client*) event->data, event->events);
+      }
+    }
+
+    run_timers(worker->timers, worker->now);
+  }
+}
+
+/*
+ * spin_budget - used to get time of spinning before blocking
+ * wait. Spinning pays off only if events arrive before it
+ * ends, so budget follows average time between events and
+ * is 0 if events arrive rarer than busy_poll allows.
+ * @worker - pointer to an object of worker struct
+ *
+ * Return: time of spinning in ns
+ */
+uint64_t spin_budget(struct worker* worker) {
+  uint64_t limit = (uint64_t) worker->server->config.busy_poll * 1000;
+  uint64_t budget = 2 * worker->arrival_gap;
+
+  if (worker->arrival_gap > limit)
+    return 0;
+
+  return budget < limit ? budget : limit;
+}
+
+/*
+ * wait_events - used to wait for ready fds. In busy-poll
+ * mode loop is checked without blocking until events arrive
+ * or spin budget is spent, then it blocks for rest of
+ * timeout. Time between events updates spin budget.
+ * @worker - pointer to an object of worker struct
+ * @timeout - timeout in ms, -1 to wait infinitely
+ *
+ * Return: amount of ready events
+ */
+int wait_events(struct worker* worker, int timeout) {
+  uint64_t start;
+  uint64_t budget;
+  uint64_t now;
+  int64_t gap;
+  int amount = 0;
+
+  if (!worker->server->config.busy_poll)
+    return loop_wait(worker->loop, timeout);
+
+  start = monotonic_ns();
+  now = start;
+  budget = spin_budget(worker);
+
+  /* Do not spin past nearest timer */
+  if (timeout >= 0 && budget > (uint64_t) timeout * 1000000)
+    budget = (uint64_t) timeout * 1000000;
+
+  /* Spin on non-blocking checks */
+  while (now - start < budget) {
+    amount = loop_wait(worker->loop, 0);
+    now = monotonic_ns();
+    if (amount > 0)
+      break;
+  }
+
+  if (amount > 0)
+    worker->spin_wakeups++;
+  else {
+    /* Block for rest of timeout */
+    if (timeout > 0) {
+      int spent = (int) ((now - start) / 1000000);
+      timeout = spent < timeout ? timeout - spent : 0;
+    }
+
+    amount = loop_wait(worker->loop, timeout);
+    now = monotonic_ns();
+    if (amount > 0)
+      worker->block_wakeups++;
+  }
+
+  /* Average time between events */
+  if (amount > 0) {
+    gap = (int64_t) (now - worker->last_arrival) - (int64_t) worker->arrival_gap;
+    worker->arrival_gap += gap / SPIN_GAP_WEIGHT;
+    worker->last_arrival = now;
+  }
+
+  return amount;
+}
+
+/*
+ * accept_clients - used to accept all pending connections
+ * and register them in event loop. TCP and AF_UNIX stream
+ * clients are served by same state machine. Connection that
+ * backend can not watch (fd above FD_SETSIZE for select) is
+ * closed.
+ * @worker - pointer to an object of worker struct
+ * @fd - file descriptor of listening socket
+ */
+void accept_clients(struct worker* worker, int fd) {
+  while (1) {
+    struct sockaddr_storage addr;
+    socklen_t client_len = sizeof(addr);
+    struct client* client;
+    int client_fd;
+
+    client_fd = accept4(fd, (struct sockaddr*) &addr, &client_len, SOCK_NONBLOCK);
+
+    /* No more pending connections */
+    if (client_fd == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      return;
+
+    /* Error occured */
+    if (client_fd == -1) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      print_error("accept4");
+    }
+
+    /* Initialize client */
+    client = create_client((struct sockaddr*) &addr, client_len, client_fd);
+    client->worker = worker;
+    if (fd == worker->tcp_fd)
+      set_busy_poll(client_fd, worker->server->config.busy_poll);
+    client->interest = worker->server->config.edge ? LOOP_READ | LOOP_WRITE : LOOP_READ;
+    
+    /* Backend is full */
+    if (loop_register(worker->loop, client_fd, client->interest | loop_mode(worker), client) == -1) {
+      printf("SERVER: Client %s rejected, %s can not watch fd %d\n", 
+             client->name, worker->loop->ops->name, client_fd);
+      free_client(client);
+      continue;
+    }
+    worker->clients++;
+
+    /* Close connection if client is idle */
+    client->last_active = worker->now;
+    init_timer(&client->idle_timer, expire_client, client);
+    schedule_timer(worker->timers, &client->idle_timer, worker->now + IDLE_TIMEOUT_MS);
+
+    /* Log connection */
+    printf("SERVER: Client %s connected\n", client->name);
+  }
+}
+
+/*
+ * loop_mode - used to get flags of client fds chosen
+ * at startup: edge-triggered and one-shot.
+ * @worker - pointer to an object of worker struct
+ *
+ * Return: LOOP_EDGE and LOOP_ONESHOT flags
+ */
+uint32_t loop_mode(struct worker* worker) {
+  uint32_t mode = 0;
+
+  if (worker->server->config.edge)
+    mode |= LOOP_EDGE;
+  if (worker->server->config.oneshot)
+    mode |= LOOP_ONESHOT;
+
+  return mode;
+}
+
+/*
+ * read_messages - used to receive up to budget messages
+ * of client and queue replies to them while output is
+ * not too big.
+ * @worker - pointer to an object of worker struct
+ * @client - pointer to an object of client struct
+ * @budget - max amount of messages
+ *
+ * Return: 0 if socket is drained or budget is spent,
+ * 1 if output is full, -1 if connection is closed
+ */
+int read_messages(struct worker* worker, struct client* client, int budget) {
+  for (int i = 0; i < budget; i++) {
+    char* message;
+    char* reply;
+    int result;
+
+    /* Stop reading until replies are sent */
+    if (pending_output(client) >= OUTPUT_LIMIT)
+      return 1;
+
+    result = recv_message(client, &message);
+
+    /* Wait for rest of message */
+    if (result == 0)
+      return 0;
+
+    /* Shutdown called */
+    if (result == -1)
+      return -1;
+
+    printf("SERVER: Received message from %s: %s\n", 
+           client->name, 
+           message);
+    client->last_active = worker->now;
+    worker->tcp_messages++;
+
+    /* Add prefix to message */
+    reply = cached_reply(worker->server->cache, message, edit_message);
+
+    /* Queue reply to client */
+    queue_reply(client, reply);
+
+    /* Log reply */
+    printf("SERVER: Send response to %s : %s\n",
+           client->name,
+           reply);
+
+    /* Free allocated memory */
+    free(reply);
+    free(message);
+  }
+
+  return 0;
+}
+
+/*
+ * communicate_tcp - used to advance state machine of
+ * client on TCP protocol. Reads up to READ_BUDGET messages,
+ * queues replies and sends as much of them as socket accepts.
+ * Edge-triggered fd is not reported again until new data
+ * arrives, so it is read until EAGAIN and reading goes on
+ * while output stopped by OUTPUT_LIMIT is sent completely.
+ * @worker - pointer to an object of worker struct
+ * @client - pointer to an object of client struct
+ * @events - ready events of client fd
+ */
+void communicate_tcp(struct worker* worker, struct client* client, uint32_t events) {
+  int edge = worker->server->config.edge;
+  int stopped;
+  int flushed;
+
+  do {
+    stopped = 0;
+
+    /* Receive messages while output is not too big */
+    if (edge || (events & (LOOP_READ | LOOP_ERROR))) {
+      stopped = read_messages(worker, client, edge ? INT_MAX : READ_BUDGET);
+      if (stopped == -1) {
+        delete_client(worker, client);
+        return;
+      }
+    }
+
+    /* Send queued replies */
+    flushed = flush_replies(client);
+    if (flushed == -1) {
+      delete_client(worker, client);
+      return;
+    }
+  } while (edge && stopped == 1 && flushed == 0);
+
+  update_interest(worker, client);
+}
+
+/*
+ * update_interest - used to watch client for writing while
+ * replies are pending and stop reading while output is full.
+ * Edge-triggered fd always watches both events, as they are
+ * reported only on change. One-shot fd is rearmed every time.
+ * @worker - pointer to an object of worker struct
+ * @client - pointer to an object of client struct
+ */
+void update_interest(struct worker* worker, struct client* client) {
+  uint32_t interest = 0;
+  size_t pending = pending_output(client);
+
+  if (worker->server->config.edge)
+    interest = LOOP_READ | LOOP_WRITE;
+  else {
+    if (pending < OUTPUT_LIMIT)
+      interest |= LOOP_READ;
+    if (pending > 0)
+      interest |= LOOP_WRITE;
+  }
+
+  if (interest != client->interest || worker->server->config.oneshot) {
+    loop_modify(worker->loop, client->fd, interest | loop_mode(worker));
+    client->interest = interest;
+  }
+}
+
+/*
+ * delete_client - used to remove client from event loop
+ * and close connection.
+ * @worker - pointer to an object of worker struct
+ * @client - pointer to an object of client struct
+ */
+void delete_client(struct worker* worker, struct client* client) {
+  printf("SERVER: Client %s disconnected\n", client->name);
+
+  cancel_timer(worker->timers, &client->idle_timer);
+  loop_unregister(worker->loop, client->fd);
+  worker->clients--;
+  free_client(client);
+}
+
+/*
+ * expire_client - used as callback of idle timer. Timer
+ * is not moved on every message, so it is scheduled again
+ * if client was active since, otherwise connection is closed.
+ * @timer - pointer to idle timer of client
+ * @data - pointer to an object of client struct
+ */
+void expire_client(struct timer* timer, void* data) {
+  struct client* client = (struct client*) data;
+  struct worker* worker = client->worker;
+  uint64_t expires = client->last_active + IDLE_TIMEOUT_MS;
+
+  if (expires > worker->now) {
+    schedule_timer(worker->timers, timer, expires);
+    return;
+  }
+
+  printf("SERVER: Client %s timed out\n", client->name);
+  delete_client(worker, client);
+}
+
+/*
+ * flush_stats - used as callback of statistics timer. Prints
+ * amount of served requests if there were any.
+ * @timer - pointer to statistics timer
+ * @data - pointer to an object of worker struct
+ */
+void flush_stats(struct timer* timer, void* data) {
+  struct worker* worker = (struct worker*) data;
+
+  if (worker->tcp_messages || worker->udp_messages || worker->expired_flows) {
+    printf("STATS: worker %d: clients %d, udp flows %zu (expired %" PRIu64 "), tcp messages %" PRIu64 ", udp datagrams %" PRIu64 " in %d ms\n",
+           worker->id, worker->clients, worker->flows->amount, worker->expired_flows,
+           worker->tcp_messages, worker->udp_messages, STATS_INTERVAL_MS);
+    fflush(stdout);
+  }
+
+  if (worker->spin_wakeups || worker->block_wakeups) {
+    printf("STATS: worker %d: spin budget %" PRIu64 " us, woken by spin %" PRIu64 ", by blocking wait %" PRIu64 "\n",
+           worker->id, spin_budget(worker) / 1000, worker->spin_wakeups, worker->block_wakeups);
+    fflush(stdout);
+  }
+
+  worker->tcp_messages = 0;
+  worker->udp_messages = 0;
+  worker->expired_flows = 0;
+  worker->spin_wakeups = 0;
+  worker->block_wakeups = 0;
+  schedule_timer(worker->timers, timer, worker->now + STATS_INTERVAL_MS);
+}
+
+/*
+ * sweep_flows - used as callback of flow timer. Removes
+ * flows of peers silent for FLOW_TIMEOUT_MS.
+ * @timer - pointer to flow timer
+ * @data - pointer to an object of worker struct
+ */
+void sweep_flows(struct timer* timer, void* data) {
+  struct worker* worker = (struct worker*) data;
+
+  worker->expired_flows += expire_flows(worker->flows, worker->now);
+  schedule_timer(worker->timers, timer, worker->now + FLOW_SWEEP_MS);
+}
+
+/*
+ * communicate_udp - used to answer batch of requests of
+ * clients on UDP or AF_UNIX datagram socket. Receives up to
+ * UDP_BATCH datagrams with one call and sends all replies
+ * with one call. With offload datagram may hold several
+ * requests of one client. Edge-triggered socket is read
+ * until batch is not full.
+ * @worker - pointer to an object of worker struct
+ * @fd - file descriptor of datagram socket
+ * @batch - pointer to batch of the socket
+ */
+void communicate_udp(struct worker* worker, int fd, struct udp_batch* batch) {
+  int amount;
+
+  do {
+    amount = recv_batch(fd, batch);
+    answer_batch(worker, fd, batch, amount);
+  } while (worker->server->config.edge && amount == UDP_BATCH);
+}
+
+/*
+ * pooled_reply - used to make reply to UDP request in buffer
+ * of pool. Reply is written without allocation, cached one
+ * is copied from cache straight to buffer. Reply that was
+ * not cached is stored to cache.
+ * @worker - pointer to an object of worker struct
+ * @message - terminated request
+ * @message_len - length of request
+ *
+ * Return: reply in buffer of pool, NULL if it does not fit
+ * in datagram
+ */
+char* pooled_reply(struct worker* worker, char* message, size_t message_len) {
+  size_t reply_len = strlen(REPLY_PREFIX) + message_len;
+  struct response_cache* cache = worker->server->cache;
+  char* reply;
+
+  if (reply_len > UDP_MAX_PAYLOAD)
+    return NULL;
+
+  reply = pool_get(worker->pool, reply_len + 1);
+  
+  /* Cached reply has the same length as formatted one */
+  if (cache && cache_lookup_into(cache, message, message_len, reply, reply_len + 1) != -1)
+    return reply;
+
+  format_reply(message, reply, reply_len + 1);
+  if (cache)
+    cache_store(cache, message, message_len, reply, reply_len);
+
+  return reply;
+}
+
+/*
+ * answer_batch - used to answer received batch of requests.
+ * Every datagram is counted in flow of its peer, which also
+ * keeps formatted address for logs. Datagram cut by MSG_TRUNC
+ * is dropped, as part of request is lost. Local client must
+ * be bound to get replies.
+ * @worker - pointer to an object of worker struct
+ * @fd - file descriptor of datagram socket
+ * @batch - pointer to batch of the socket
+ * @amount - amount of received datagrams
+ */
+void answer_batch(struct worker* worker, int fd, struct udp_batch* batch, int amount) {
+  for (int i = 0; i < amount; i++) {
+    struct sockaddr* client = (struct sockaddr*) &batch->addrs[i];
+    socklen_t client_len = batch->recv_msgs[i].msg_hdr.msg_namelen;
+    char* buffer = batch_buffer(batch, i);
+    size_t length = batch->recv_msgs[i].msg_len;
+    size_t segment = segment_size(batch, i);
+    size_t segments = length ? (length + segment - 1) / segment : 1;
+    int first = batch->reply_amount;
+    char fallback[ADDRESS_SIZE];
+    const char* name = fallback;
+    struct flow* flow;
+
+    /* Count datagram in flow of peer */
+    flow = find_flow(worker->flows, client, client_len, worker->now);
+    if (flow) {
+      update_flow(flow, segments, length, worker->now);
+      name = flow->name;
+    }
+    /* Table is full, peer is not tracked */
+    else
+      format_address(client, client_len, fallback, sizeof(fallback));
+
+    /* Datagram did not fit in buffer */
+    if (batch->recv_msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+      printf("SERVER: Datagram from %s is bigger than %zu bytes, dropped\n", 
+             name, batch->buffer_size);
+      continue;
+    }
+
+    /* Empty datagram is one empty request */
+    for (size_t n = 0; n < segments; n++) {
+      size_t offset = n * segment;
+      size_t end = offset + segment < length ? offset + segment : length;
+      char saved = buffer[end];
+      char* reply;
+
+      /* Terminate request, keep first byte of next one */
+      buffer[end] = '\0';
+      reply = pooled_reply(worker, buffer + offset, end - offset);
+
+      /* Log received message */
+      printf("SERVER: Received message from %s: %s\n", 
+             name, 
+             buffer + offset);
+
+      /* Reply does not fit in datagram */
+      if (!reply) {
+        printf("SERVER: Response to %s is bigger than %d bytes, dropped\n",
+               name, UDP_MAX_PAYLOAD);
+        buffer[end] = saved;
+        continue;
+      }
+
+      /* Log reply */
+      printf("SERVER: Send response to %s : %s\n",
+             name, 
+             reply);
+
+      buffer[end] = saved;
+      add_reply(batch, reply);
+      worker->udp_messages++;
+    }
+
+    queue_replies(batch, client, client_len, first);
+  }
+
+  /* Send responses */
+  flush_batch(fd, batch);
+}
+
+/*
+ * free_worker - used to free memory of worker. Own
+ * sockets of worker are closed.
+ * @worker - pointer to an object of worker struct
+ */
+void free_worker(struct worker* worker) {
+  if (worker->tcp_fd != worker->server->tcp_fd) {
+    close(worker->tcp_fd);
+    close(worker->udp_fd);
+  }
+  free_loop(worker->loop);
+  free_flow_table(worker->flows);
+  free_udp_batch(worker->udp_batch);
+  free_udp_batch(worker->unix_batch);
+  free_buffer_pool(worker->pool);
+  free_timer_queue(worker->timers);
+  free(worker);
+}